@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ * @file    ChannelMux.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of ChannelMux for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "ChannelMux.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/* Bytes handed to the sink at a time. */
+#define CHANNEL_MUX_CHUNK       16
+
+/** Constructor
+ * @brief	constructor.
+ * @param	Sink the frames are written to
+ */
+ChannelMux::ChannelMux(Sink out) : out(out), head(0), tail(0), used(0), draining(false), dropped(0) {
+}
+
+/** send
+ * @brief	Sends data on a channel, safe to call from interrupts.
+ * @param	Channel
+ * @param	Data
+ * @param	Data length
+ */
+void ChannelMux::send(Channel channel, const char *data, size_t length) {
+    while (length > 0) {
+        size_t count = length < CHANNEL_MUX_FRAME_SIZE ? length : CHANNEL_MUX_FRAME_SIZE;
+
+        while (!queue(channel, data, count)) {
+            // full, send what is there unless another writer already does
+            if (drain()) continue;
+
+            // that writer is what this interrupt interrupted, it cannot be waited for
+            if (core_util_is_isr_active()) {
+                core_util_critical_section_enter();
+                dropped++;
+                core_util_critical_section_exit();
+
+                if (onDropped) onDropped();
+                break;
+            }
+#ifdef MBED_CONF_RTOS_PRESENT
+            Thread::yield();
+#endif
+        }
+
+        data += count;
+        length -= count;
+    }
+
+    drain();
+}
+
+/** attach
+ * @brief	Sets what to call when a frame is dropped, it is called in the interrupt.
+ * @param	Function, e.g. one that schedules takeDropped() and a repaint
+ */
+void ChannelMux::attach(Callback<void()> func) {
+    onDropped = func;
+}
+
+/** takeDropped
+ * @brief	Gets the number of frames lost to a full queue since the last call.
+ * @return  Frames
+ */
+size_t ChannelMux::takeDropped() {
+    core_util_critical_section_enter();
+    size_t count = dropped;
+    dropped = 0;
+    core_util_critical_section_exit();
+
+    return count;
+}
+
+/** queue
+ * @brief	Adds a whole frame to the queue.
+ * @param	Channel
+ * @param	Payload
+ * @param	Payload length, at most CHANNEL_MUX_FRAME_SIZE
+ * @return  false if it does not fit
+ */
+bool ChannelMux::queue(Channel channel, const char *data, size_t length) {
+    char header[3] = { CHANNEL_MUX_START, (char)channel, (char)length };
+
+    core_util_critical_section_enter();
+
+    bool fits = used + sizeof(header) + length <= sizeof(ring);
+    if (fits) {
+        for (size_t ix = 0; ix < sizeof(header) + length; ix++) {
+            ring[tail] = ix < sizeof(header) ? header[ix] : data[ix - sizeof(header)];
+            tail = (tail + 1) % sizeof(ring);
+        }
+        used += sizeof(header) + length;
+    }
+
+    core_util_critical_section_exit();
+    return fits;
+}
+
+/** drain
+ * @brief	Sends the queued frames, unless another writer is already doing it.
+ * @return  false if another writer is
+ */
+bool ChannelMux::drain() {
+    char chunk[CHANNEL_MUX_CHUNK];
+
+    core_util_critical_section_enter();
+    bool first = !draining;
+    draining = true;
+    core_util_critical_section_exit();
+
+    if (!first) return false;
+
+    while (true) {
+        size_t count = 0;
+
+        // frames queued meanwhile (also from interrupts) are sent by this loop
+        core_util_critical_section_enter();
+        while (count < sizeof(chunk) && used > 0) {
+            chunk[count++] = ring[head];
+            head = (head + 1) % sizeof(ring);
+            used--;
+        }
+        if (count == 0) {
+            draining = false;
+        }
+        core_util_critical_section_exit();
+
+        if (count == 0) return true;
+
+        out(chunk, count);
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file    ChannelMux.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Header file for ChannelMux, framed output channels for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _CHANNELMUX_H
+#define _CHANNELMUX_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "mbed_critical.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Payload bytes per frame, longer writes are split (at most 255). */
+#ifndef CHANNEL_MUX_FRAME_SIZE
+#define CHANNEL_MUX_FRAME_SIZE  64
+#endif
+
+/* Bytes waiting for the serial port, frames go in whole so they never interleave. */
+#ifndef CHANNEL_MUX_QUEUE_SIZE
+#define CHANNEL_MUX_QUEUE_SIZE  512
+#endif
+
+/* First byte of every frame, never sent by the editor. */
+#define CHANNEL_MUX_START       0x1e
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * ChannelMux class which shares the serial port between several output
+ * channels. Every write becomes one or more frames of a start byte, the
+ * channel, the payload length and the payload, so payloads need no escaping.
+ * Frames are queued whole and sent by whichever writer comes first, which
+ * keeps writes from interrupts and threads from interleaving. A frame from an
+ * interrupt that finds the queue full is dropped, see attach().
+ */
+class ChannelMux {
+public:
+    enum Channel {
+        EDITOR = 'E',   /* echo, prompt and repaints */
+        STDOUT = 'O',   /* results and console output */
+        LOG = 'L',      /* errors */
+        DATA = 'D'      /* binary data from the program */
+    };
+
+    /* Output sink. */
+    typedef Callback<void(const char *, size_t)> Sink;
+
+    /* Constructor. */
+    ChannelMux(Sink out);
+
+    /* Functions. */
+    void send(Channel channel, const char *data, size_t length);
+    void attach(Callback<void()> func);
+    size_t takeDropped();
+
+private:
+    bool queue(Channel channel, const char *data, size_t length);
+    bool drain();
+
+private:
+    Sink out;
+
+    /* Frames waiting to be sent. */
+    char ring[CHANNEL_MUX_QUEUE_SIZE];
+    size_t head;
+    size_t tail;
+    size_t used;
+    bool draining;
+
+    /* Frames lost to a full queue since takeDropped(), and who gets told (in the interrupt). */
+    size_t dropped;
+    Callback<void()> onDropped;
+};
+
+#endif // _CHANNELMUX_H
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file    EditorThread.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of EditorThread for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "EditorThread.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+#ifdef __MBED__
+
+/** Constructor
+ * @brief	constructor.
+ */
+EditorThread::EditorThread() : thread(osPriorityNormal, EDITOR_THREAD_STACK_SIZE) {
+}
+
+/** start
+ * @brief	Starts the thread.
+ */
+void EditorThread::start() {
+    thread.start(Callback<void()>(this, &EditorThread::run));
+}
+
+/** post
+ * @brief	Queues a work item, safe to call from interrupts.
+ * @param	Work item
+ * @return  false if the queue is full
+ */
+bool EditorThread::post(Callback<void()> work) {
+    Callback<void()> *item = queue.alloc();
+    if (!item) return false;
+
+    *item = work;
+    queue.put(item);
+    return true;
+}
+
+/** run
+ * @brief	Thread body, runs the work items in order.
+ */
+void EditorThread::run() {
+    while (true) {
+        osEvent event = queue.get();
+        if (event.status != osEventMail) continue;
+
+        Callback<void()> *item = (Callback<void()> *)event.value.p;
+        Callback<void()> work = *item;
+        queue.free(item);
+
+        lock();
+        work();
+        unlock();
+    }
+}
+
+#else
+
+std::atomic<int> EditorThread::pending(0);
+
+/** Constructor
+ * @brief	constructor.
+ */
+EditorThread::EditorThread() {
+}
+
+/** start
+ * @brief	Starts the thread.
+ */
+void EditorThread::start() {
+    thread = std::thread(&EditorThread::run, this);
+    thread.detach();
+}
+
+/** post
+ * @brief	Queues a work item.
+ * @param	Work item
+ * @return  false if the queue is full
+ */
+bool EditorThread::post(Callback<void()> work) {
+    std::lock_guard<std::mutex> guard(queueMutex);
+
+    if (queue.size() >= EDITOR_THREAD_QUEUE_SIZE) return false;
+
+    queue.push_back(work);
+    pending++;
+    queueReady.notify_one();
+    return true;
+}
+
+/** run
+ * @brief	Thread body, runs the work items in order.
+ */
+void EditorThread::run() {
+    while (true) {
+        Callback<void()> work;
+        {
+            std::unique_lock<std::mutex> guard(queueMutex);
+            queueReady.wait(guard, [this] { return !queue.empty(); });
+
+            work = queue.front();
+            queue.pop_front();
+        }
+
+        lock();
+        work();
+        unlock();
+
+        pending--;
+    }
+}
+
+/** idle
+ * @brief	Checks that the editor threads are done with everything posted, for the host harness.
+ * @return  true if no work item is queued or running
+ */
+bool EditorThread::idle() {
+    return pending == 0;
+}
+
+#endif
+
+/** lock
+ * @brief	Takes the editor lock, recursive.
+ */
+void EditorThread::lock() {
+    mutex.lock();
+}
+
+/** unlock
+ * @brief	Releases the editor lock.
+ */
+void EditorThread::unlock() {
+    mutex.unlock();
+}
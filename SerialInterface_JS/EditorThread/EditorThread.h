@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file    EditorThread.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of EditorThread for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _EDITORTHREAD_H
+#define _EDITORTHREAD_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+#ifndef __MBED__
+// host build: std::thread stand-in for the RTOS primitives
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#endif
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Work items that can be waiting for the editor thread. */
+#ifndef EDITOR_THREAD_QUEUE_SIZE
+#define EDITOR_THREAD_QUEUE_SIZE    16
+#endif
+
+/* Stack of the editor thread. */
+#ifndef EDITOR_THREAD_STACK_SIZE
+#define EDITOR_THREAD_STACK_SIZE    2048
+#endif
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * EditorThread class which runs editor work items one by one on a thread of
+ * their own, so that the editor stays responsive while the JavaScript event
+ * loop is busy running a script. Every work item runs with the editor lock
+ * held; other threads take the lock before touching editor state.
+ */
+class EditorThread {
+public:
+
+    /* Constructor. */
+    EditorThread();
+
+    /* Functions. */
+    void start();
+    bool post(Callback<void()> work);
+    void lock();
+    void unlock();
+#ifndef __MBED__
+    static bool idle();
+#endif
+
+private:
+    void run();
+
+private:
+#ifdef __MBED__
+    Thread thread;
+    Mail<Callback<void()>, EDITOR_THREAD_QUEUE_SIZE> queue;
+    Mutex mutex;
+#else
+    std::thread thread;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Callback<void()> > queue;
+    std::recursive_mutex mutex;
+
+    /* Work items posted and not done yet, over all editor threads. */
+    static std::atomic<int> pending;
+#endif
+};
+
+#endif // _EDITORTHREAD_H
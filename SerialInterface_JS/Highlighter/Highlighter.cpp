@@ -0,0 +1,297 @@
+/**
+ ******************************************************************************
+ * @file    Highlighter.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of Highlighter for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "Highlighter.h"
+
+/* Keywords ------------------------------------------------------------------*/
+
+static const char *keywords[] = {
+    "break", "case", "catch", "class", "const", "continue", "debugger",
+    "default", "delete", "do", "else", "export", "extends", "false",
+    "finally", "for", "function", "if", "import", "in", "instanceof", "let",
+    "new", "null", "return", "super", "switch", "this", "throw", "true",
+    "try", "typeof", "undefined", "var", "void", "while", "with", "yield"
+};
+
+/* Helpers -------------------------------------------------------------------*/
+
+static bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ */
+Highlighter::Highlighter() {
+}
+
+/** rebuild
+ * @brief	Lexes the whole buffer from scratch.
+ * @param	Buffer
+ */
+void Highlighter::rebuild(SerialBuffer &buffer) {
+    tokens.clear();
+
+    for (size_t at = 0; at < buffer.size(); ) {
+        Type type;
+        size_t end = lex(buffer, at, type);
+
+        Token token = { (uint32_t)at, (uint8_t)type };
+        tokens.push_back(token);
+
+        at = end;
+    }
+}
+
+/** update
+ * @brief	Lexes again the part of the buffer an edit may have changed.
+ * @param	Buffer, already edited
+ * @param	Offset of the edit
+ * @param	Number of characters inserted at the offset
+ * @param	Number of characters removed at the offset
+ * @param	Start of the span whose colour changed (output)
+ * @param	End of the span whose colour changed (output)
+ */
+void Highlighter::update(SerialBuffer &buffer, size_t pos, size_t inserted, size_t removed, size_t &from, size_t &to) {
+    size_t size = buffer.size();
+    size_t oldSize = size - inserted + removed;
+
+    from = pos;
+    to = pos + inserted;
+
+    // tokens look up to two characters past their end, start lexing at
+    // the one that may have seen the edit
+    size_t first = tokens.empty() ? 0 : tokenAt(pos > 2 ? pos - 2 : 0);
+    size_t restart = tokens.empty() ? 0 : tokens[first].start;
+
+    size_t last = first;
+    while (last < tokens.size() && tokens[last].start < pos + removed) last++;
+
+    // lex until a token starts where an old, untouched one did
+    vector<Token> fresh;
+    size_t at = restart;
+
+    while (at < size) {
+        if (at >= pos + inserted) {
+            while (last < tokens.size() && tokens[last].start - removed + inserted < at) last++;
+            if (last < tokens.size() && tokens[last].start - removed + inserted == at) break;
+        }
+
+        Type type;
+        size_t end = lex(buffer, at, type);
+
+        Token token = { (uint32_t)at, (uint8_t)type };
+        fresh.push_back(token);
+
+        at = end;
+    }
+
+    if (at >= size) {
+        last = tokens.size();
+    }
+
+    // find what changed colour outside the edit itself
+    size_t oldIx = first;
+    size_t newIx = 0;
+
+    for (size_t ix = restart; ix < at; ix++) {
+        if (ix >= pos && ix < pos + inserted) continue;
+
+        size_t oldPos = ix < pos ? ix : ix - inserted + removed;
+
+        while (oldIx + 1 < last && tokens[oldIx + 1].start <= oldPos) oldIx++;
+        while (newIx + 1 < fresh.size() && fresh[newIx + 1].start <= ix) newIx++;
+
+        bool hadOld = oldIx < last && oldPos < oldSize;
+        const char *oldColor = hadOld ? color((Type)tokens[oldIx].type) : NULL;
+        const char *newColor = color((Type)fresh[newIx].type);
+
+        if (oldColor != newColor) {
+            if (ix < from) from = ix;
+            if (ix + 1 > to) to = ix + 1;
+        }
+    }
+
+    // splice the fresh tokens in, move the untouched ones
+    for (size_t ix = last; ix < tokens.size(); ix++) {
+        tokens[ix].start = tokens[ix].start - removed + inserted;
+    }
+
+    tokens.erase(tokens.begin() + first, tokens.begin() + last);
+    tokens.insert(tokens.begin() + first, fresh.begin(), fresh.end());
+}
+
+/** typeAt
+ * @brief	Returns the type of the token at an offset.
+ * @param	Buffer
+ * @param	Offset
+ * @param	End of the token (output)
+ * @return  Token type
+ */
+Highlighter::Type Highlighter::typeAt(SerialBuffer &buffer, size_t pos, size_t &end) {
+    if (tokens.empty()) {
+        end = buffer.size();
+        return PLAIN;
+    }
+
+    size_t ix = tokenAt(pos);
+    end = ix + 1 < tokens.size() ? tokens[ix + 1].start : buffer.size();
+
+    return (Type)tokens[ix].type;
+}
+
+/** color
+ * @brief	Returns the escape sequence for a token type.
+ * @param	Token type
+ * @return  SGR sequence, NULL for the terminal's default
+ */
+const char *Highlighter::color(Type type) {
+    switch (type) {
+        case KEYWORD:   return "\033[35m";
+        case NUMBER:    return "\033[33m";
+        case STRING:    return "\033[32m";
+        case COMMENT:   return "\033[90m";
+        default:        return NULL;
+    }
+}
+
+/** tokenAt
+ * @brief	Returns the index of the token holding an offset.
+ * @param	Offset
+ * @return  Token index
+ */
+size_t Highlighter::tokenAt(size_t pos) {
+    size_t low = 0;
+    size_t high = tokens.size();
+
+    // last token starting at or before pos
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (tokens[mid].start <= pos) low = mid;
+        else high = mid;
+    }
+
+    return low;
+}
+
+/** lex
+ * @brief	Lexes one token.
+ * @param	Buffer
+ * @param	Offset the token starts at
+ * @param	Token type (output)
+ * @return  Offset just past the token
+ */
+size_t Highlighter::lex(SerialBuffer &buffer, size_t pos, Type &type) {
+    size_t size = buffer.size();
+    size_t end = pos + 1;
+    char c = buffer.at(pos);
+    char next = end < size ? buffer.at(end) : '\0';
+
+    if (isIdentifierStart(c)) {
+        while (end < size && (isIdentifierStart(buffer.at(end)) || isDigit(buffer.at(end)))) end++;
+        type = isKeyword(buffer, pos, end) ? KEYWORD : IDENTIFIER;
+    }
+    else if (isDigit(c)) {
+        while (end < size && (isIdentifierStart(buffer.at(end)) || isDigit(buffer.at(end)) || buffer.at(end) == '.')) end++;
+        type = NUMBER;
+    }
+    else if (c == '"' || c == '\'' || c == '`') {
+        // strings end at the closing quote, only template strings span lines
+        while (end < size) {
+            char s = buffer.at(end);
+            if (s == '\n' && c != '`') break;
+            end++;
+            if (s == '\\' && end < size) end++;
+            else if (s == c) break;
+        }
+        type = STRING;
+    }
+    else if (c == '/' && next == '/') {
+        while (end < size && buffer.at(end) != '\n') end++;
+        type = COMMENT;
+    }
+    else if (c == '/' && next == '*') {
+        end++;
+        while (end < size && !(buffer.at(end - 1) == '*' && buffer.at(end) == '/' && end - 1 > pos + 1)) end++;
+        if (end < size) end++;
+        type = COMMENT;
+    }
+    else {
+        // whitespace and punctuation up to the next token that gets a colour
+        while (end < size) {
+            char p = buffer.at(end);
+            char q = end + 1 < size ? buffer.at(end + 1) : '\0';
+
+            if (isIdentifierStart(p) || isDigit(p) || p == '"' || p == '\'' || p == '`') break;
+            if (p == '/' && (q == '/' || q == '*')) break;
+            end++;
+        }
+        type = PLAIN;
+    }
+
+    return end;
+}
+
+/** isKeyword
+ * @brief	Checks if an identifier is a keyword.
+ * @param	Buffer
+ * @param	Start of the identifier
+ * @param	End of the identifier
+ * @return  true if it's a keyword
+ */
+bool Highlighter::isKeyword(SerialBuffer &buffer, size_t start, size_t end) {
+    size_t length = end - start;
+
+    for (size_t ix = 0; ix < sizeof(keywords) / sizeof(keywords[0]); ix++) {
+        if (strlen(keywords[ix]) != length) continue;
+
+        size_t jx = 0;
+        while (jx < length && keywords[ix][jx] == buffer.at(start + jx)) jx++;
+        if (jx == length) return true;
+    }
+
+    return false;
+}
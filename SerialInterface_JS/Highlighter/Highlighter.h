@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file    Highlighter.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of Highlighter for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _HIGHLIGHTER_H
+#define _HIGHLIGHTER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "SerialBuffer.h"
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Highlighter class which splits the buffer into JavaScript tokens and keeps
+ * them up to date incrementally: after an edit only the tokens from the one
+ * before the edit up to the first unchanged token boundary are lexed again.
+ */
+class Highlighter {
+public:
+    enum Type {
+        PLAIN,
+        IDENTIFIER,
+        KEYWORD,
+        NUMBER,
+        STRING,
+        COMMENT
+    };
+
+    /* Constructor. */
+    Highlighter();
+
+    /* Functions. */
+    void rebuild(SerialBuffer &buffer);
+    void update(SerialBuffer &buffer, size_t pos, size_t inserted, size_t removed, size_t &from, size_t &to);
+    Type typeAt(SerialBuffer &buffer, size_t pos, size_t &end);
+    static const char *color(Type type);
+
+private:
+    /* A token runs from its start to the start of the next one. */
+    struct Token {
+        uint32_t start;
+        uint8_t type;
+    };
+
+    size_t tokenAt(size_t pos);
+    size_t lex(SerialBuffer &buffer, size_t pos, Type &type);
+    bool isKeyword(SerialBuffer &buffer, size_t start, size_t end);
+
+private:
+    vector<Token> tokens;
+};
+
+#endif // _HIGHLIGHTER_H
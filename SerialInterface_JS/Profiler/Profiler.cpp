@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * @file    Profiler.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of Profiler.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "Profiler.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ */
+Profiler::Profiler() : head(0), count(0), start(0), heapBefore(0) {
+    memset(&current, 0, sizeof(current));
+}
+
+/** begin
+ * @brief	Starts profiling a run, call right before parsing.
+ * @param	Size of the source in bytes
+ */
+void Profiler::begin(size_t codeSize) {
+    size_t peak;
+
+    memset(&current, 0, sizeof(current));
+    current.codeSize = codeSize;
+    current.heapValid = sampleHeap(heapBefore, peak);
+
+    start = us_ticker_read();
+}
+
+/** parsed
+ * @brief	Marks the end of parsing, the rest is run time.
+ */
+void Profiler::parsed() {
+    uint32_t now = us_ticker_read();
+
+    current.parseTime = now - start;
+    start = now;
+}
+
+/** end
+ * @brief	Finishes the run and keeps it.
+ * @param	Whether parsing and running succeeded
+ */
+void Profiler::end(bool ok) {
+    current.runTime = us_ticker_read() - start;
+    current.ok = ok;
+
+    size_t allocated, peak;
+    if (current.heapValid && sampleHeap(allocated, peak)) {
+        current.heapDelta = (int32_t)allocated - (int32_t)heapBefore;
+        current.heapPeak = peak;
+    }
+    else {
+        current.heapValid = false;
+    }
+
+    records[head] = current;
+    head = (head + 1) % PROFILER_RUNS;
+    if (count < PROFILER_RUNS) count++;
+}
+
+/** last
+ * @brief	Gets the latest run.
+ * @return  Record
+ */
+const ProfileRecord &Profiler::last() {
+    return current;
+}
+
+/** size
+ * @brief	Gets the number of runs kept.
+ * @return  Number of runs
+ */
+size_t Profiler::size() {
+    return count;
+}
+
+/** get
+ * @brief	Gets a run, oldest first.
+ * @param	Index
+ * @param	Record to fill
+ * @return  false if index is out of range
+ */
+bool Profiler::get(size_t index, ProfileRecord &record) {
+    if (index >= count) return false;
+
+    record = records[(head + PROFILER_RUNS - count + index) % PROFILER_RUNS];
+    return true;
+}
+
+/** clear
+ * @brief	Forgets all runs.
+ */
+void Profiler::clear() {
+    head = 0;
+    count = 0;
+}
+
+/** sampleHeap
+ * @brief	Reads the JerryScript heap statistics.
+ * @param	Bytes allocated now
+ * @param	Most bytes ever allocated
+ * @return  false if JerryScript keeps no statistics
+ */
+bool Profiler::sampleHeap(size_t &allocated, size_t &peak) {
+#ifdef PROFILER_HEAP_STATS
+    jerry_heap_stats_t stats;
+
+    if (jerry_get_memory_stats(&stats)) {
+        allocated = stats.allocated_bytes;
+        peak = stats.peak_allocated_bytes;
+        return true;
+    }
+#endif
+
+    allocated = 0;
+    peak = 0;
+    return false;
+}
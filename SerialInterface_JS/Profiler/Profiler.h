@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ * @file    Profiler.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Times script runs and samples the JerryScript heap.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+
+#include "jerryscript.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Number of runs kept, oldest ones get overwritten. */
+#ifndef PROFILER_RUNS
+#define PROFILER_RUNS   8
+#endif
+
+/* Define PROFILER_HEAP_STATS when JerryScript is built with memory statistics
+ * (JERRY_MEM_STATS), the heap columns stay empty otherwise. */
+
+/* Types ---------------------------------------------------------------------*/
+
+/* One profiled run. */
+struct ProfileRecord {
+    uint32_t parseTime;     /* us */
+    uint32_t runTime;       /* us */
+    uint32_t codeSize;      /* bytes of source */
+    int32_t heapDelta;      /* bytes still allocated after the run */
+    uint32_t heapPeak;      /* highest heap use since boot */
+    bool heapValid;         /* heap fields are set */
+    bool ok;                /* parsed and ran without error */
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * Profiler class which times the parse and run steps of a script, samples
+ * the JerryScript heap around them and keeps the last runs in a ring.
+ * Not thread safe: end() and the readers of the ring need the same lock.
+ */
+class Profiler {
+public:
+
+    /* Constructor. */
+    Profiler();
+
+    /* Functions. */
+    void begin(size_t codeSize);
+    void parsed();
+    void end(bool ok);
+    const ProfileRecord &last();
+    size_t size();
+    bool get(size_t index, ProfileRecord &record);
+    void clear();
+
+private:
+    static bool sampleHeap(size_t &allocated, size_t &peak);
+
+private:
+    ProfileRecord records[PROFILER_RUNS];
+
+    /* Index of the next record to write. */
+    size_t head;
+    size_t count;
+
+    /* Run in progress. */
+    ProfileRecord current;
+    uint32_t start;
+    size_t heapBefore;
+};
+
+#endif // _PROFILER_H
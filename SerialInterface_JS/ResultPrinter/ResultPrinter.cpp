@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ * @file    ResultPrinter.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of ResultPrinter for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "ResultPrinter.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ * @param	Sink the result is written to
+ */
+ResultPrinter::ResultPrinter(Sink out) : out(out), written(0), truncated(false) {
+    setLimits(RESULT_PRINTER_MAX_DEPTH, RESULT_PRINTER_MAX_ELEMENTS, RESULT_PRINTER_MAX_BYTES);
+}
+
+/** setLimits
+ * @brief	Sets how much of a result gets printed.
+ * @param	Nesting depth (clamped to RESULT_PRINTER_DEPTH_CEILING)
+ * @param	Elements/properties per array/object
+ * @param	Bytes per result
+ */
+void ResultPrinter::setLimits(size_t maxDepth, size_t maxElements, size_t maxBytes) {
+    this->maxDepth = maxDepth > RESULT_PRINTER_DEPTH_CEILING ? RESULT_PRINTER_DEPTH_CEILING : maxDepth;
+    this->maxElements = maxElements;
+    this->maxBytes = maxBytes;
+}
+
+/** print
+ * @brief	Streams a value to the output sink.
+ * @param	Value to print
+ */
+void ResultPrinter::print(jerry_value_t value) {
+    written = 0;
+    truncated = false;
+
+    printValue(value, 0);
+
+    if (truncated) {
+        out("...", 3);
+    }
+}
+
+/** printValue
+ * @brief	Prints any value.
+ * @param	Value to print
+ * @param	Current nesting depth
+ */
+void ResultPrinter::printValue(jerry_value_t value, size_t depth) {
+    if (jerry_value_is_string(value)) {
+        printString(value, true);
+    }
+    else if (jerry_value_is_function(value)) {
+        write("[Function]");
+    }
+    else if (jerry_value_is_array(value)) {
+        printArray(value, depth);
+    }
+    else if (jerry_value_is_object(value)) {
+        printObject(value, depth);
+    }
+    else {
+        // undefined, null, boolean and number are all short
+        jerry_value_t str_value = jerry_value_to_string(value);
+        printString(str_value, false);
+        jerry_release_value(str_value);
+    }
+}
+
+/** printString
+ * @brief	Prints a string in fixed size chunks.
+ * @param	String value
+ * @param	Whether to surround the string with quotes
+ */
+void ResultPrinter::printString(jerry_value_t str, bool quoted) {
+    jerry_char_t chunk[RESULT_PRINTER_CHUNK_CHARS * 3];
+    jerry_length_t length = jerry_get_string_length(str);
+
+    if (quoted) write("\"");
+
+    for (jerry_length_t pos = 0; pos < length && !truncated; pos += RESULT_PRINTER_CHUNK_CHARS) {
+        jerry_length_t end = pos + RESULT_PRINTER_CHUNK_CHARS;
+        if (end > length) end = length;
+
+        jerry_size_t size = jerry_substring_to_char_buffer(str, pos, end, chunk, sizeof(chunk));
+        write((const char *)chunk, size);
+    }
+
+    if (quoted) write("\"");
+}
+
+/** printArray
+ * @brief	Prints an array element by element.
+ * @param	Array value
+ * @param	Current nesting depth
+ */
+void ResultPrinter::printArray(jerry_value_t array, size_t depth) {
+    if (isOnPath(array, depth)) {
+        write("[Circular]");
+        return;
+    }
+
+    uint32_t length = jerry_get_array_length(array);
+
+    if (depth >= maxDepth) {
+        write(length ? "[...]" : "[]");
+        return;
+    }
+
+    path[depth] = array;
+
+    write("[");
+    for (uint32_t ix = 0; ix < length && !truncated; ix++) {
+        if (ix) write(", ");
+
+        if (ix == maxElements) {
+            write("...");
+            break;
+        }
+
+        jerry_value_t element = jerry_get_property_by_index(array, ix);
+        printValue(element, depth + 1);
+        jerry_release_value(element);
+    }
+    write("]");
+}
+
+/** printObject
+ * @brief	Prints an object property by property.
+ * @param	Object value
+ * @param	Current nesting depth
+ */
+void ResultPrinter::printObject(jerry_value_t object, size_t depth) {
+    if (isOnPath(object, depth)) {
+        write("[Circular]");
+        return;
+    }
+
+    // listing the keys only to tell {} from {...} would cost as much as printing them
+    if (depth >= maxDepth) {
+        write("{...}");
+        return;
+    }
+
+    jerry_value_t keys = jerry_get_object_keys(object);
+    uint32_t length = jerry_get_array_length(keys);
+
+    path[depth] = object;
+
+    write("{");
+    for (uint32_t ix = 0; ix < length && !truncated; ix++) {
+        if (ix) write(", ");
+
+        if (ix == maxElements) {
+            write("...");
+            break;
+        }
+
+        jerry_value_t key = jerry_get_property_by_index(keys, ix);
+        jerry_value_t property = jerry_get_property(object, key);
+
+        printString(key, false);
+        write(": ");
+        printValue(property, depth + 1);
+
+        jerry_release_value(property);
+        jerry_release_value(key);
+    }
+    write("}");
+
+    jerry_release_value(keys);
+}
+
+/** isOnPath
+ * @brief	Checks if an object is already being printed by an outer level.
+ * @param	Object value
+ * @param	Current nesting depth
+ * @return  true if printing it again would recurse forever
+ */
+bool ResultPrinter::isOnPath(jerry_value_t object, size_t depth) {
+    // object values refer to the same object iff they compare equal
+    for (size_t ix = 0; ix < depth && ix < RESULT_PRINTER_DEPTH_CEILING; ix++) {
+        if (path[ix] == object) return true;
+    }
+    return false;
+}
+
+/** write
+ * @brief	Writes bytes to the output sink, honouring the byte limit.
+ * @param	Data
+ * @param	Data length
+ */
+void ResultPrinter::write(const char *data, size_t length) {
+    if (truncated) return;
+
+    if (written + length > maxBytes) {
+        length = maxBytes - written;
+        truncated = true;
+
+        // don't cut a CESU-8 sequence, its continuation bytes are 10xxxxxx
+        while (length && ((unsigned char)data[length] & 0xc0) == 0x80) {
+            length--;
+        }
+    }
+
+    if (length) {
+        out(data, length);
+    }
+    written += length;
+}
+
+/** write
+ * @brief	Writes a zero terminated string to the output sink.
+ * @param	String
+ */
+void ResultPrinter::write(const char *s) {
+    write(s, strlen(s));
+}
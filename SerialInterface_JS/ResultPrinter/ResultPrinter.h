@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * @file    ResultPrinter.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of ResultPrinter for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _RESULTPRINTER_H
+#define _RESULTPRINTER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "jerryscript.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Hard ceiling for nesting, sizes the fixed cycle detection path. */
+#ifndef RESULT_PRINTER_DEPTH_CEILING
+#define RESULT_PRINTER_DEPTH_CEILING    8
+#endif
+
+/* Default number of nested levels printed. */
+#ifndef RESULT_PRINTER_MAX_DEPTH
+#define RESULT_PRINTER_MAX_DEPTH        3
+#endif
+
+/* Default number of elements/properties printed per array/object. */
+#ifndef RESULT_PRINTER_MAX_ELEMENTS
+#define RESULT_PRINTER_MAX_ELEMENTS     32
+#endif
+
+/* Default number of bytes printed for a single result. */
+#ifndef RESULT_PRINTER_MAX_BYTES
+#define RESULT_PRINTER_MAX_BYTES        1024
+#endif
+
+/* Characters copied out of a string at once (CESU-8 uses up to 3 bytes). */
+#ifndef RESULT_PRINTER_CHUNK_CHARS
+#define RESULT_PRINTER_CHUNK_CHARS      16
+#endif
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * ResultPrinter class which streams a JS value to an output sink, chunk by
+ * chunk, without materialising it as one string.
+ */
+class ResultPrinter {
+public:
+
+    /* Output sink. */
+    typedef Callback<void(const char *, size_t)> Sink;
+
+    /* Constructor. */
+    ResultPrinter(Sink out);
+
+    /* Functions. */
+    void setLimits(size_t maxDepth, size_t maxElements, size_t maxBytes);
+    void print(jerry_value_t value);
+
+private:
+    void printValue(jerry_value_t value, size_t depth);
+    void printString(jerry_value_t str, bool quoted);
+    void printArray(jerry_value_t array, size_t depth);
+    void printObject(jerry_value_t object, size_t depth);
+    bool isOnPath(jerry_value_t object, size_t depth);
+    void write(const char *data, size_t length);
+    void write(const char *s);
+
+private:
+    Sink out;
+
+    size_t maxDepth;
+    size_t maxElements;
+    size_t maxBytes;
+
+    /* Bytes written for the current result. */
+    size_t written;
+    bool truncated;
+
+    /* Objects currently being printed, for cycle detection. */
+    jerry_value_t path[RESULT_PRINTER_DEPTH_CEILING];
+};
+
+#endif // _RESULTPRINTER_H
@@ -0,0 +1,528 @@
+/**
+ ******************************************************************************
+ * @file    ScriptFlash.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of ScriptFlash.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "ScriptFlash.h"
+#include "Crc32.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/* "JSFL" */
+#define SCRIPT_FLASH_MAGIC  0x4c46534a
+
+/* Erased flash reads as this. */
+#define SCRIPT_FLASH_ERASED 0xff
+
+/** Constructor
+ * @brief	constructor.
+ */
+ScriptFlash::ScriptFlash() : ready(false), error(NULL), start(0), end(0), dataStart(0), pageSize(0),
+    slotSize(0), slots(0), current(0), hasHeader(false) {
+    headerSectors[0] = headerSectors[1] = 0;
+    nextSlot[0] = nextSlot[1] = 0;
+    memset(&header, 0, sizeof(header));
+}
+
+/** getRegion
+ * @brief	Works out where the region is, also for ScriptStore to stay below it.
+ * @param	Flash, initialised
+ * @param	Set to the region start, a sector boundary
+ * @param	Set to the region end
+ * @param	Set to why there is no region
+ * @return  false if the region does not fit the flash, or overlaps the firmware
+ */
+bool ScriptFlash::getRegion(FlashIAP &flash, uint32_t &start, uint32_t &end, const char *&reason) {
+    uint32_t flashStart = flash.get_flash_start();
+    uint32_t flashEnd = flashStart + flash.get_flash_size();
+
+    reason = "region outside flash";
+
+#if defined(SCRIPT_FLASH_SIZE)
+#ifdef SCRIPT_FLASH_ADDRESS
+    uint32_t wanted = SCRIPT_FLASH_ADDRESS;
+    end = wanted + SCRIPT_FLASH_SIZE;
+#else
+    uint32_t wanted = flashEnd - SCRIPT_FLASH_SIZE;
+    end = flashEnd;
+#endif
+
+    if (SCRIPT_FLASH_SIZE > flashEnd - flashStart || wanted < flashStart || end > flashEnd) {
+        return false;
+    }
+
+    start = sectorStart(flash, wanted);
+#elif defined(SCRIPT_FLASH_ADDRESS)
+    if (SCRIPT_FLASH_ADDRESS < flashStart || SCRIPT_FLASH_ADDRESS >= flashEnd) {
+        return false;
+    }
+
+    start = sectorStart(flash, SCRIPT_FLASH_ADDRESS);
+    end = start;
+    for (size_t ix = 0; ix < SCRIPT_FLASH_SECTORS; ix++) {
+        if (end >= flashEnd) return false;
+        end += flash.get_sector_size(end);
+    }
+
+#ifdef SCRIPT_FLASH_DEFAULT_SECTORS
+    if (end - start > SCRIPT_FLASH_DEFAULT_LIMIT) {
+        reason = "sectors too big, set SCRIPT_FLASH_SECTORS";
+        return false;
+    }
+#endif
+#elif defined(SCRIPT_FLASH_DEFAULT_SECTORS)
+    // as many sectors as the limit allows, the program gets the room
+    end = flashEnd;
+    if (sectorsWithin(flash, end, SCRIPT_FLASH_DEFAULT_LIMIT, start) < SCRIPT_FLASH_SECTORS) {
+        reason = "sectors too big, set SCRIPT_FLASH_SECTORS";
+        return false;
+    }
+#else
+    end = flashEnd;
+    if (!sectorsBefore(flash, end, SCRIPT_FLASH_SECTORS, start)) {
+        return false;
+    }
+#endif
+
+    if (overlapsImage(start)) {
+        reason = "region overlaps firmware";
+        return false;
+    }
+
+    reason = NULL;
+    return true;
+}
+
+/** overlapsImage
+ * @brief	Tells whether a region would start inside the firmware image.
+ * @param	Region start
+ * @return  true if below the end of the image
+ */
+bool ScriptFlash::overlapsImage(uint32_t start) {
+#if defined(SCRIPT_FLASH_IMAGE_END)
+    return start < (uint32_t)(SCRIPT_FLASH_IMAGE_END);
+#else
+    (void)start;
+    return false;
+#endif
+}
+
+/** sectorStart
+ * @brief	Finds the sector holding an address, sectors can differ in size.
+ * @param	Flash, initialised
+ * @param	Address, up to the end of the flash
+ * @return  Start of the sector, or the address itself if it is a sector boundary
+ */
+uint32_t ScriptFlash::sectorStart(FlashIAP &flash, uint32_t address) {
+    uint32_t start = flash.get_flash_start();
+
+    while (start < address && start + flash.get_sector_size(start) <= address) {
+        start += flash.get_sector_size(start);
+    }
+    return start;
+}
+
+/** sectorsBefore
+ * @brief	Finds the start of the last sectors before a sector boundary.
+ * @param	Flash, initialised
+ * @param	Sector boundary
+ * @param	Number of sectors
+ * @param	Set to the start of the first of them
+ * @return  false if there are fewer sectors before the boundary
+ */
+bool ScriptFlash::sectorsBefore(FlashIAP &flash, uint32_t end, size_t count, uint32_t &start) {
+    uint32_t lead = flash.get_flash_start();
+
+    // lead runs count sectors ahead, start is where it was when lead reaches the end
+    for (size_t ix = 0; ix < count; ix++) {
+        if (lead >= end) return false;
+        lead += flash.get_sector_size(lead);
+    }
+
+    start = flash.get_flash_start();
+    while (lead < end) {
+        lead += flash.get_sector_size(lead);
+        start += flash.get_sector_size(start);
+    }
+    return lead == end;
+}
+
+/** sectorsWithin
+ * @brief	Finds the last whole sectors before a sector boundary that fit in a size.
+ * @param	Flash, initialised
+ * @param	Sector boundary
+ * @param	Size in bytes
+ * @param	Set to the start of the first of them, the boundary if none fits
+ * @return  Number of sectors
+ */
+size_t ScriptFlash::sectorsWithin(FlashIAP &flash, uint32_t end, uint32_t size, uint32_t &start) {
+    uint32_t flashStart = flash.get_flash_start();
+    uint32_t wanted = end - flashStart > size ? end - size : flashStart;
+    size_t count = 0;
+
+    // the sector holding wanted only counts if it starts there
+    start = sectorStart(flash, wanted);
+    if (start < wanted) {
+        start += flash.get_sector_size(start);
+    }
+
+    for (uint32_t address = start; address < end; address += flash.get_sector_size(address)) {
+        count++;
+    }
+    return count;
+}
+
+/** init
+ * @brief	Works out the region and finds the end of the header journal.
+ * @return  false if the region does not fit the flash
+ */
+bool ScriptFlash::init() {
+    if (ready) return true;
+
+    if (flash.init() != 0) {
+        return fail("flash init failed");
+    }
+
+    const char *reason;
+    if (!getRegion(flash, start, end, reason)) {
+        return fail(reason);
+    }
+
+    // two sectors for the headers, the program follows
+    headerSectors[0] = start;
+    headerSectors[1] = start + flash.get_sector_size(start);
+    dataStart = headerSectors[1] + flash.get_sector_size(headerSectors[1]);
+    if (end <= headerSectors[1] || dataStart >= end) {
+        return fail("region too small");
+    }
+
+    pageSize = flash.get_page_size();
+    slotSize = (sizeof(ScriptFlashHeader) + pageSize - 1) / pageSize * pageSize;
+    uint32_t headerSize = headerSectors[1] - headerSectors[0];
+    if (dataStart - headerSectors[1] < headerSize) {
+        headerSize = dataStart - headerSectors[1];
+    }
+    slots = headerSize / slotSize;
+
+    // headers are written in order, find the first empty slot of each sector
+    for (int which = 0; which < 2; which++) {
+        size_t lo = 0, hi = slots;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (isEmptySlot(which, mid)) hi = mid;
+            else lo = mid + 1;
+        }
+        nextSlot[which] = lo;
+    }
+
+    // the newest header of either sector is the current one
+    ScriptFlashHeader record;
+
+    hasHeader = false;
+    current = 0;
+
+    for (int which = 0; which < 2; which++) {
+        if (readHeader(which, record) && (!hasHeader || record.sequence > header.sequence)) {
+            header = record;
+            hasHeader = true;
+            current = which;
+        }
+    }
+
+    ready = true;
+    return true;
+}
+
+/** load
+ * @brief	Finds the committed program, in place in the (memory mapped) flash.
+ * @param	Set to the program
+ * @param	Set to its length
+ * @param	Trust the header CRC instead of reading the program back
+ * @return  false if there is no valid program
+ */
+bool ScriptFlash::load(const char *&code, size_t &length, bool fast) {
+    if (!init()) return false;
+
+    if (!hasHeader || header.state != COMMITTED) {
+        return fail("no program");
+    }
+
+    if (!fast && crcOf(dataStart, header.length) != header.crc) {
+        return fail("crc mismatch");
+    }
+
+    code = (const char *)(uintptr_t)dataStart;
+    length = header.length;
+    return true;
+}
+
+/** store
+ * @brief	Stores a program, erasing and programming only the sectors that changed.
+ * @param	Program
+ * @param	Program length
+ * @param	Filled with what was done
+ * @return  false if the program could not be stored
+ */
+bool ScriptFlash::store(const char *code, size_t length, ScriptFlashStats &stats) {
+    uint32_t began = us_ticker_read();
+
+    memset(&stats, 0, sizeof(stats));
+
+    if (!init()) return false;
+
+    if (length > capacity()) {
+        return fail("program too big");
+    }
+
+    uint32_t crc = Crc32::update(0, code, length);
+    bool committed = hasHeader && header.state == COMMITTED;
+    bool pending = false;
+
+    size_t offset = 0;
+    for (uint32_t address = dataStart; offset < length; stats.sectors++) {
+        uint32_t size = flash.get_sector_size(address);
+        size_t count = length - offset < size ? length - offset : size;
+
+        if (matches(address, code + offset, count)) {
+            stats.skipped++;
+        }
+        else {
+            // from here on the stored program is not the committed one any more
+            if (!pending) {
+                if (!writeHeader(PENDING, length, crc)) return false;
+                pending = true;
+            }
+
+            uint32_t before = us_ticker_read();
+            if (!writeSector(address, size, code + offset, count)) return false;
+            stats.writeTime += us_ticker_read() - before;
+            stats.written++;
+        }
+
+        address += size;
+        offset += count;
+    }
+
+    // only a new length (or a half finished update) is left to commit
+    if (pending || !committed || header.length != length || header.crc != crc) {
+        if (crcOf(dataStart, length) != crc) {
+            return fail("verify failed");
+        }
+        if (!writeHeader(COMMITTED, length, crc)) return false;
+    }
+
+    stats.time = us_ticker_read() - began;
+    return true;
+}
+
+/** capacity
+ * @brief	Gets the largest program that fits.
+ * @return  Bytes
+ */
+size_t ScriptFlash::capacity() {
+    return ready ? end - dataStart : 0;
+}
+
+/** getError
+ * @brief	Gets why the last operation failed.
+ * @return  Reason, or NULL
+ */
+const char *ScriptFlash::getError() {
+    return error;
+}
+
+/** fail
+ * @brief	Remembers why an operation failed.
+ * @param	Reason
+ * @return  false
+ */
+bool ScriptFlash::fail(const char *reason) {
+    error = reason;
+    return false;
+}
+
+/** readHeader
+ * @brief	Reads the newest intact header of a journal sector.
+ * @param	Journal sector, 0 or 1
+ * @param	Record to fill
+ * @return  false if there is none
+ */
+bool ScriptFlash::readHeader(int which, ScriptFlashHeader &record) {
+    // a header cut short by a reset is skipped, nothing was rewritten before it
+    for (size_t slot = nextSlot[which]; slot > 0; slot--) {
+        if (flash.read(&record, headerSectors[which] + (slot - 1) * slotSize, sizeof(record)) == 0 &&
+            record.magic == SCRIPT_FLASH_MAGIC &&
+            record.check == Crc32::update(0, &record, offsetof(ScriptFlashHeader, check)) &&
+            record.length <= end - dataStart) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** writeHeader
+ * @brief	Appends a header to the journal, moving to the other sector once full.
+ * @param	State
+ * @param	Program length
+ * @param	Program CRC
+ * @return  false if erasing or programming failed
+ */
+bool ScriptFlash::writeHeader(State state, uint32_t length, uint32_t crc) {
+    if (nextSlot[current] == slots) {
+        // the full sector keeps the current header until the other one has it
+        int other = 1 - current;
+        if (flash.erase(headerSectors[other], flash.get_sector_size(headerSectors[other])) != 0) {
+            return fail("header erase failed");
+        }
+        nextSlot[other] = 0;
+        current = other;
+    }
+
+    ScriptFlashHeader next;
+    next.magic = SCRIPT_FLASH_MAGIC;
+    next.sequence = header.sequence + 1;
+    next.state = state;
+    next.length = length;
+    next.crc = crc;
+    next.check = Crc32::update(0, &next, offsetof(ScriptFlashHeader, check));
+
+    // programming goes by whole pages
+    char *slot = new char[slotSize];
+    memset(slot, SCRIPT_FLASH_ERASED, slotSize);
+    memcpy(slot, &next, sizeof(next));
+
+    int result = flash.program(slot, headerSectors[current] + nextSlot[current] * slotSize, slotSize);
+    delete[] slot;
+
+    // the slot is spoilt either way
+    nextSlot[current]++;
+
+    if (result != 0) {
+        return fail("header program failed");
+    }
+
+    header = next;
+    hasHeader = true;
+    return true;
+}
+
+/** isEmptySlot
+ * @brief	Tells whether a header slot was never written.
+ * @param	Journal sector, 0 or 1
+ * @param	Slot
+ * @return  true if still erased
+ */
+bool ScriptFlash::isEmptySlot(int which, size_t slot) {
+    uint32_t magic;
+
+    flash.read(&magic, headerSectors[which] + slot * slotSize, sizeof(magic));
+    return magic == 0xffffffff;
+}
+
+/** matches
+ * @brief	Compares data with what the flash holds.
+ * @param	Flash address
+ * @param	Data
+ * @param	Data length
+ * @return  true if the same
+ */
+bool ScriptFlash::matches(uint32_t address, const char *data, size_t length) {
+    char chunk[SCRIPT_FLASH_CHUNK];
+
+    for (size_t offset = 0; offset < length; offset += sizeof(chunk)) {
+        size_t count = length - offset < sizeof(chunk) ? length - offset : sizeof(chunk);
+
+        if (flash.read(chunk, address + offset, count) != 0 || memcmp(chunk, data + offset, count) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** writeSector
+ * @brief	Erases a sector and programs data into it.
+ * @param	Sector address
+ * @param	Sector size
+ * @param	Data
+ * @param	Data length, at most the sector size
+ * @return  false if erasing or programming failed
+ */
+bool ScriptFlash::writeSector(uint32_t address, uint32_t size, const char *data, size_t length) {
+    if (flash.erase(address, size) != 0) {
+        return fail("erase failed");
+    }
+
+    // whole pages straight from the data, the last one padded
+    size_t whole = length / pageSize * pageSize;
+    if (whole && flash.program(data, address, whole) != 0) {
+        return fail("program failed");
+    }
+
+    if (whole < length) {
+        char *page = new char[pageSize];
+        memset(page, SCRIPT_FLASH_ERASED, pageSize);
+        memcpy(page, data + whole, length - whole);
+
+        int result = flash.program(page, address + whole, pageSize);
+        delete[] page;
+
+        if (result != 0) {
+            return fail("program failed");
+        }
+    }
+    return true;
+}
+
+/** crcOf
+ * @brief	Computes the CRC of what the flash holds.
+ * @param	Flash address
+ * @param	Length
+ * @return  CRC-32
+ */
+uint32_t ScriptFlash::crcOf(uint32_t address, size_t length) {
+    char chunk[SCRIPT_FLASH_CHUNK];
+    uint32_t crc = 0;
+
+    for (size_t offset = 0; offset < length; offset += sizeof(chunk)) {
+        size_t count = length - offset < sizeof(chunk) ? length - offset : sizeof(chunk);
+
+        flash.read(chunk, address + offset, count);
+        crc = Crc32::update(crc, chunk, count);
+    }
+    return crc;
+}
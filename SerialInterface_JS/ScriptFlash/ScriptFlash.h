@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file    ScriptFlash.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Stores the program in flash, rewriting only the sectors that changed.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _SCRIPTFLASH_H
+#define _SCRIPTFLASH_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Size of the flash region, it ends at the end of the flash unless SCRIPT_FLASH_ADDRESS is set.
+ * The region is widened down to a sector boundary, and must not overlap what Flasher uses.
+ * It needs at least three sectors, so it is left undefined by default: sector sizes range from
+ * 2 KB to 128 KB (STM32F4/F7 top sectors), SCRIPT_FLASH_SECTORS whole sectors are used instead. */
+/* #define SCRIPT_FLASH_SIZE */
+
+/* Sectors of the region when SCRIPT_FLASH_SIZE is not set: two for the header journal, the rest for
+ * the program.
+ * Left at the default, the region takes the last sectors that fit in SCRIPT_FLASH_DEFAULT_LIMIT
+ * bytes and init() fails if that is fewer: set SCRIPT_FLASH_SECTORS to opt in to big sectors. */
+#ifndef SCRIPT_FLASH_SECTORS
+#define SCRIPT_FLASH_SECTORS    3
+#define SCRIPT_FLASH_DEFAULT_SECTORS
+#endif
+
+/* Largest region taken without SCRIPT_FLASH_SECTORS or SCRIPT_FLASH_SIZE set. */
+#ifndef SCRIPT_FLASH_DEFAULT_LIMIT
+#define SCRIPT_FLASH_DEFAULT_LIMIT  0x10000
+#endif
+
+/* End of the firmware image, the regions of ScriptFlash and ScriptStore must not start below it.
+ * FlashIAP gives it from mbed OS 5.10 on, set it for older versions (0 skips the check). */
+#ifndef SCRIPT_FLASH_IMAGE_END
+#if defined(FLASHIAP_APP_ROM_END_ADDR)
+#define SCRIPT_FLASH_IMAGE_END  FLASHIAP_APP_ROM_END_ADDR
+#elif defined(SERIAL_INTERFACE_SCRIPT_FLASH) || defined(SERIAL_INTERFACE_SCRIPT_STORE)
+#error "SCRIPT_FLASH_IMAGE_END must be set to the end of the firmware image"
+#endif
+#endif
+
+#if SCRIPT_FLASH_SECTORS < 3
+#error "SCRIPT_FLASH_SECTORS must be at least 3, two for the header journal and one for the program"
+#endif
+
+/* Whether booting trusts the header CRC instead of checking the whole program again. */
+#ifndef SCRIPT_FLASH_FAST_BOOT
+#define SCRIPT_FLASH_FAST_BOOT  1
+#endif
+
+/* Bytes compared against the flash at a time. */
+#ifndef SCRIPT_FLASH_CHUNK
+#define SCRIPT_FLASH_CHUNK      64
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+
+/* Commit record, the first two sectors of the region each hold a journal of these. */
+struct ScriptFlashHeader {
+    uint32_t magic;
+    uint32_t sequence;      /* the highest one is current */
+    uint32_t state;         /* PENDING while sectors get rewritten, then COMMITTED */
+    uint32_t length;        /* bytes of program */
+    uint32_t crc;           /* CRC-32 of the program */
+    uint32_t check;         /* CRC-32 of the fields above */
+};
+
+/* What a store() did. */
+struct ScriptFlashStats {
+    uint32_t sectors;       /* sectors the program spans */
+    uint32_t written;       /* sectors erased and programmed */
+    uint32_t skipped;       /* sectors already holding the right bytes */
+    uint32_t time;          /* us for the whole update */
+    uint32_t writeTime;     /* us spent erasing and programming sectors */
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * ScriptFlash class which keeps the program in a flash region behind a
+ * journal of commit headers, written to two sectors in turn so the current
+ * header survives the erase of a full one. A new program is compared with
+ * the stored one sector by sector and only the sectors that differ are
+ * erased and programmed. The commit header written last carries the CRC of
+ * the whole program, so booting can trust it instead of reading the program
+ * back.
+ */
+class ScriptFlash {
+public:
+    enum State {
+        PENDING = 1,
+        COMMITTED = 2
+    };
+
+    /* Constructor. */
+    ScriptFlash();
+
+    /* Functions. */
+    static bool getRegion(FlashIAP &flash, uint32_t &start, uint32_t &end, const char *&reason);
+    static bool overlapsImage(uint32_t start);
+    static uint32_t sectorStart(FlashIAP &flash, uint32_t address);
+    static bool sectorsBefore(FlashIAP &flash, uint32_t end, size_t count, uint32_t &start);
+    static size_t sectorsWithin(FlashIAP &flash, uint32_t end, uint32_t size, uint32_t &start);
+
+    bool init();
+    bool load(const char *&code, size_t &length, bool fast);
+    bool store(const char *code, size_t length, ScriptFlashStats &stats);
+    size_t capacity();
+    const char *getError();
+
+private:
+    bool fail(const char *reason);
+    bool readHeader(int which, ScriptFlashHeader &record);
+    bool writeHeader(State state, uint32_t length, uint32_t crc);
+    bool isEmptySlot(int which, size_t slot);
+    bool matches(uint32_t address, const char *data, size_t length);
+    bool writeSector(uint32_t address, uint32_t size, const char *data, size_t length);
+    uint32_t crcOf(uint32_t address, size_t length);
+
+private:
+    FlashIAP flash;
+    bool ready;
+    const char *error;
+
+    /* Geometry of the region. */
+    uint32_t start;
+    uint32_t end;
+    uint32_t dataStart;
+    uint32_t pageSize;
+
+    /* Header journal, in the first two sectors. */
+    uint32_t headerSectors[2];
+    size_t slotSize;
+    size_t slots;
+    size_t nextSlot[2];
+    int current;
+
+    /* Copy of the current header. */
+    ScriptFlashHeader header;
+    bool hasHeader;
+};
+
+#endif // _SCRIPTFLASH_H
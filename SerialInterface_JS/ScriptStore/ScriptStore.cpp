@@ -0,0 +1,656 @@
+/**
+ ******************************************************************************
+ * @file    ScriptStore.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of ScriptStore for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "ScriptStore.h"
+#include "Crc32.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/* "JSDX" */
+#define SCRIPT_STORE_MAGIC  0x5844534a
+
+/* Erased flash reads as this. */
+#define SCRIPT_STORE_ERASED 0xff
+
+/** Constructor
+ * @brief	constructor.
+ */
+ScriptStore::ScriptStore() : ready(false), error(NULL), start(0), end(0), dataStart(0), pageSize(0),
+    slotSize(0), slots(0), current(0) {
+    nextSlot[0] = nextSlot[1] = 0;
+    memset(&index, 0, sizeof(index));
+}
+
+/** findRegion
+ * @brief	Works out where the region starts and ends, on sector boundaries.
+ * @return  false if the region does not fit the flash, or overlaps the firmware
+ */
+bool ScriptStore::findRegion() {
+#ifdef SCRIPT_STORE_ADDRESS
+    uint32_t flashEnd = flash.get_flash_start() + flash.get_flash_size();
+
+    if (SCRIPT_STORE_ADDRESS < flash.get_flash_start() || SCRIPT_STORE_ADDRESS >= flashEnd) {
+        return fail("region outside flash");
+    }
+
+    start = ScriptFlash::sectorStart(flash, SCRIPT_STORE_ADDRESS);
+#ifdef SCRIPT_STORE_SIZE
+    if (SCRIPT_STORE_SIZE > flashEnd - SCRIPT_STORE_ADDRESS) {
+        return fail("region outside flash");
+    }
+    end = ScriptFlash::sectorStart(flash, SCRIPT_STORE_ADDRESS + SCRIPT_STORE_SIZE);
+#else
+    end = start;
+    for (size_t ix = 0; ix < SCRIPT_STORE_SECTORS; ix++) {
+        if (end >= flashEnd) return fail("region outside flash");
+        end += flash.get_sector_size(end);
+    }
+
+#ifdef SCRIPT_STORE_DEFAULT_SECTORS
+    if (end - start > SCRIPT_STORE_DEFAULT_LIMIT) {
+        return fail("sectors too big, set SCRIPT_STORE_SECTORS");
+    }
+#endif
+#endif
+#else
+#ifdef SCRIPT_STORE_RESERVED
+    if (SCRIPT_STORE_RESERVED > flash.get_flash_size()) {
+        return fail("region outside flash");
+    }
+    end = ScriptFlash::sectorStart(flash, flash.get_flash_start() + flash.get_flash_size() - SCRIPT_STORE_RESERVED);
+#else
+    // right below the Ctrl+F region
+    uint32_t reservedEnd;
+    const char *reason;
+    if (!ScriptFlash::getRegion(flash, end, reservedEnd, reason)) {
+        return fail(reason);
+    }
+#endif
+
+#if defined(SCRIPT_STORE_SIZE)
+    if (SCRIPT_STORE_SIZE > end - flash.get_flash_start()) {
+        return fail("region outside flash");
+    }
+    start = ScriptFlash::sectorStart(flash, end - SCRIPT_STORE_SIZE);
+#elif defined(SCRIPT_STORE_DEFAULT_SECTORS)
+    if (ScriptFlash::sectorsWithin(flash, end, SCRIPT_STORE_DEFAULT_LIMIT, start) < SCRIPT_STORE_SECTORS) {
+        return fail("sectors too big, set SCRIPT_STORE_SECTORS");
+    }
+#else
+    if (!ScriptFlash::sectorsBefore(flash, end, SCRIPT_STORE_SECTORS, start)) {
+        return fail("region outside flash");
+    }
+#endif
+#endif
+
+    if (ScriptFlash::overlapsImage(start)) {
+        return fail("region overlaps firmware");
+    }
+    return true;
+}
+
+/** init
+ * @brief	Works out the region and reads the index into RAM.
+ * @return  false if the region does not fit the flash
+ */
+bool ScriptStore::init() {
+    if (ready) return true;
+
+    if (flash.init() != 0) {
+        return fail("flash init failed");
+    }
+
+    if (!findRegion()) return false;
+
+    // two sectors for the index, the programs follow
+    indexSectors[0] = start;
+    indexSectors[1] = start + flash.get_sector_size(start);
+    dataStart = indexSectors[1] + flash.get_sector_size(indexSectors[1]);
+    if (end <= indexSectors[1] || dataStart >= end) {
+        return fail("region too small");
+    }
+
+    pageSize = flash.get_page_size();
+    slotSize = (sizeof(ScriptIndex) + pageSize - 1) / pageSize * pageSize;
+    uint32_t indexSize = indexSectors[1] - indexSectors[0];
+    if (dataStart - indexSectors[1] < indexSize) {
+        indexSize = dataStart - indexSectors[1];
+    }
+    slots = indexSize / slotSize;
+    if (slots == 0) {
+        return fail("index does not fit a sector");
+    }
+
+    // records are written in order, find the first empty slot of each sector
+    for (int which = 0; which < 2; which++) {
+        size_t lo = 0, hi = slots;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (isEmptySlot(which, mid)) hi = mid;
+            else lo = mid + 1;
+        }
+        nextSlot[which] = lo;
+    }
+
+    // the newest record of either sector is the index
+    ScriptIndex record;
+
+    index.magic = SCRIPT_STORE_MAGIC;
+    current = 0;
+
+    for (int which = 0; which < 2; which++) {
+        if (readIndex(which, record) && record.sequence >= index.sequence) {
+            index = record;
+            current = which;
+        }
+    }
+
+    ready = true;
+    return true;
+}
+
+/** save
+ * @brief	Stores a program under a name, replacing the one of the same name.
+ * @param	Name
+ * @param	Program
+ * @param	Program length
+ * @return  false if the program could not be stored
+ */
+bool ScriptStore::save(const char *name, const char *code, size_t length) {
+    if (!init()) return false;
+
+    size_t nameLength = strlen(name);
+    if (nameLength == 0 || nameLength >= SCRIPT_STORE_NAME_SIZE) {
+        return fail("bad name");
+    }
+    for (size_t ix = 0; ix < nameLength; ix++) {
+        if (name[ix] <= ' ' || name[ix] > '~') return fail("bad name");
+    }
+
+    uint32_t crc = Crc32::update(0, code, length);
+    int ix = lookup(name);
+
+    if (ix >= 0) {
+        const ScriptEntry &entry = index.entries[ix];
+
+        // nothing to write
+        if (entry.length == length && entry.crc == crc &&
+            memcmp((const char *)(uintptr_t)(start + entry.offset), code, length) == 0) {
+            return true;
+        }
+    }
+    else if (index.count == SCRIPT_STORE_ENTRIES) {
+        return fail("index full");
+    }
+
+    // the old version stays until the index points at the new one
+    uint32_t address;
+    if (!allocate(length, address) || !writeData(address, code, length)) {
+        return false;
+    }
+
+    ScriptIndex next = index;
+    ScriptEntry &entry = next.entries[ix >= 0 ? ix : next.count++];
+
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.name, name, nameLength);
+    entry.offset = address - start;
+    entry.length = length;
+    entry.crc = crc;
+
+    return writeIndex(next);
+}
+
+/** find
+ * @brief	Looks a program up in the index, in place in the (memory mapped) flash.
+ * @param	Name
+ * @param	Set to the program
+ * @param	Set to its length
+ * @return  false if there is no such program, or it is damaged
+ */
+bool ScriptStore::find(const char *name, const char *&code, size_t &length) {
+    if (!init()) return false;
+
+    int ix = lookup(name);
+    if (ix < 0) {
+        return fail("no such script");
+    }
+
+    const ScriptEntry &entry = index.entries[ix];
+    const char *data = (const char *)(uintptr_t)(start + entry.offset);
+
+    if (Crc32::update(0, data, entry.length) != entry.crc) {
+        return fail("crc mismatch");
+    }
+
+    code = data;
+    length = entry.length;
+    return true;
+}
+
+/** remove
+ * @brief	Removes a program from the index, its pages are free once their sector is erased.
+ * @param	Name
+ * @return  false if there is no such program, or the index could not be written
+ */
+bool ScriptStore::remove(const char *name) {
+    if (!init()) return false;
+
+    int ix = lookup(name);
+    if (ix < 0) {
+        return fail("no such script");
+    }
+
+    ScriptIndex next = index;
+    next.count--;
+    memmove(&next.entries[ix], &next.entries[ix + 1], (next.count - ix) * sizeof(ScriptEntry));
+    memset(&next.entries[next.count], 0, sizeof(ScriptEntry));
+
+    return writeIndex(next);
+}
+
+/** size
+ * @brief	Gets the number of stored programs.
+ * @return  Number of programs
+ */
+size_t ScriptStore::size() {
+    return init() ? index.count : 0;
+}
+
+/** get
+ * @brief	Gets an index entry.
+ * @param	Entry index
+ * @param	Entry to fill
+ * @return  false if out of range
+ */
+bool ScriptStore::get(size_t ix, ScriptEntry &entry) {
+    if (ix >= size()) return false;
+
+    entry = index.entries[ix];
+    return true;
+}
+
+/** available
+ * @brief	Gets the bytes no program takes, old versions are cleared away to make use of them.
+ * @return  Bytes
+ */
+size_t ScriptStore::available() {
+    size_t used = 0;
+
+    if (!init()) return 0;
+
+    for (size_t ix = 0; ix < index.count; ix++) {
+        used += roundToPages(index.entries[ix].length);
+    }
+    return end - dataStart - used;
+}
+
+/** getError
+ * @brief	Gets why the last operation failed.
+ * @return  Reason, or NULL
+ */
+const char *ScriptStore::getError() {
+    return error;
+}
+
+/** fail
+ * @brief	Remembers why an operation failed.
+ * @param	Reason
+ * @return  false
+ */
+bool ScriptStore::fail(const char *reason) {
+    error = reason;
+    return false;
+}
+
+/** lookup
+ * @brief	Finds a name in the index.
+ * @param	Name
+ * @return  Entry index, -1 if not there
+ */
+int ScriptStore::lookup(const char *name) {
+    for (size_t ix = 0; ix < index.count; ix++) {
+        if (strncmp(index.entries[ix].name, name, SCRIPT_STORE_NAME_SIZE) == 0) {
+            return int(ix);
+        }
+    }
+    return -1;
+}
+
+/** roundToPages
+ * @brief	Gets the bytes of the whole pages a program takes.
+ * @param	Program length
+ * @return  Bytes
+ */
+size_t ScriptStore::roundToPages(size_t length) {
+    return (length + pageSize - 1) / pageSize * pageSize;
+}
+
+/** isUsed
+ * @brief	Tells whether a program lives in part of the flash.
+ * @param	Address
+ * @param	Size
+ * @return  true if used
+ */
+bool ScriptStore::isUsed(uint32_t address, uint32_t size) {
+    for (size_t ix = 0; ix < index.count; ix++) {
+        uint32_t from = start + index.entries[ix].offset;
+        uint32_t to = from + roundToPages(index.entries[ix].length);
+
+        if (from < to && from < address + size && address < to) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** isErased
+ * @brief	Tells whether part of the (memory mapped) flash can be programmed.
+ * @param	Address
+ * @param	Size
+ * @return  true if erased
+ */
+bool ScriptStore::isErased(uint32_t address, uint32_t size) {
+    const uint8_t *data = (const uint8_t *)(uintptr_t)address;
+
+    for (uint32_t ix = 0; ix < size; ix++) {
+        if (data[ix] != SCRIPT_STORE_ERASED) return false;
+    }
+    return true;
+}
+
+/** findRoom
+ * @brief	Finds the first run of erased pages no program uses.
+ * @param	Program length
+ * @param	Sector to keep out of, 0 for none
+ * @param	Set to the address of the first page
+ * @return  false if there is no such run
+ */
+bool ScriptStore::findRoom(size_t length, uint32_t avoid, uint32_t &address) {
+    size_t size = roundToPages(length);
+    uint32_t avoidEnd = avoid ? avoid + flash.get_sector_size(avoid) : 0;
+    uint32_t from = dataStart;
+
+    for (uint32_t page = dataStart; page - from < size; page += pageSize) {
+        if (page >= end) return false;
+
+        // start again after a page that can't be had
+        if ((page >= avoid && page < avoidEnd) || isUsed(page, pageSize) || !isErased(page, pageSize)) {
+            from = page + pageSize;
+        }
+    }
+
+    address = from;
+    return true;
+}
+
+/** allocate
+ * @brief	Finds erased pages for a program, clearing old versions away if needed.
+ * @param	Program length
+ * @param	Set to the address of the first page
+ * @return  false if there is no room, or erasing or moving failed
+ */
+bool ScriptStore::allocate(size_t length, uint32_t &address) {
+    // the last erased sector is kept for compact() to move programs to
+    while (!findRoom(length, spareSector(), address)) {
+        // sectors only old versions are left in go first, then the programs of a sector move out
+        bool erased, moved;
+
+        if (!reclaim(erased)) return false;
+        if (erased) continue;
+
+        if (!compact(moved)) return false;
+        if (!moved) return fail("no room");
+    }
+    return true;
+}
+
+/** spareSector
+ * @brief	Finds the last program sector that is erased.
+ * @return  Its address, 0 if there is none
+ */
+uint32_t ScriptStore::spareSector() {
+    uint32_t spare = 0;
+
+    for (uint32_t sector = dataStart; sector < end; sector += flash.get_sector_size(sector)) {
+        if (!isUsed(sector, flash.get_sector_size(sector)) && isErased(sector, flash.get_sector_size(sector))) {
+            spare = sector;
+        }
+    }
+    return spare;
+}
+
+/** reclaim
+ * @brief	Erases the program sectors no program uses any more.
+ * @param	Set to whether any was erased
+ * @return  false if erasing failed
+ */
+bool ScriptStore::reclaim(bool &erased) {
+    erased = false;
+
+    for (uint32_t sector = dataStart; sector < end; sector += flash.get_sector_size(sector)) {
+        uint32_t size = flash.get_sector_size(sector);
+
+        if (!isUsed(sector, size) && !isErased(sector, size)) {
+            if (flash.erase(sector, size) != 0) {
+                return fail("erase failed");
+            }
+            erased = true;
+        }
+    }
+    return true;
+}
+
+/** compact
+ * @brief	Moves the programs out of the sector old versions take most of, to the spare sector
+ *          and whatever other room there is.
+ * @param	Set to whether they moved, then reclaim() erases the sector
+ * @return  false if programming or writing the index failed
+ */
+bool ScriptStore::compact(bool &moved) {
+    uint32_t victim = 0;
+    size_t most = 0;
+
+    moved = false;
+
+    for (uint32_t sector = dataStart; sector < end; sector += flash.get_sector_size(sector)) {
+        size_t stale = 0;
+
+        for (uint32_t page = sector; page < sector + flash.get_sector_size(sector); page += pageSize) {
+            if (!isUsed(page, pageSize) && !isErased(page, pageSize)) {
+                stale += pageSize;
+            }
+        }
+
+        if (stale > most) {
+            most = stale;
+            victim = sector;
+        }
+    }
+
+    if (most == 0) return true;
+
+    // the copies only count once the index points at them
+    ScriptIndex next = index;
+    uint32_t victimEnd = victim + flash.get_sector_size(victim);
+
+    for (size_t ix = 0; ix < next.count; ix++) {
+        ScriptEntry &entry = next.entries[ix];
+        uint32_t from = start + entry.offset;
+        uint32_t address;
+
+        if (entry.length == 0 || from >= victimEnd || from + roundToPages(entry.length) <= victim) {
+            continue;
+        }
+
+        if (!findRoom(entry.length, victim, address)) return true;
+        if (!writeData(address, (const char *)(uintptr_t)from, entry.length)) return false;
+
+        entry.offset = address - start;
+    }
+
+    if (!writeIndex(next)) return false;
+
+    moved = true;
+    return true;
+}
+
+/** writeData
+ * @brief	Programs a program into erased pages and verifies it.
+ * @param	Address of the first page
+ * @param	Program, in RAM or in the flash
+ * @param	Program length
+ * @return  false if programming or verifying failed
+ */
+bool ScriptStore::writeData(uint32_t address, const char *code, size_t length) {
+    uint32_t crc = Crc32::update(0, code, length);
+    size_t chunkSize = roundToPages(SCRIPT_STORE_CHUNK);
+    char *chunk = new char[chunkSize];
+    int result = 0;
+
+    // through RAM, a program being moved is in the flash itself; the last page padded
+    for (size_t offset = 0; offset < length && result == 0; offset += chunkSize) {
+        size_t count = length - offset < chunkSize ? length - offset : chunkSize;
+
+        memset(chunk, SCRIPT_STORE_ERASED, chunkSize);
+        memcpy(chunk, code + offset, count);
+        result = flash.program(chunk, address + offset, roundToPages(count));
+    }
+    delete[] chunk;
+
+    if (result != 0) {
+        return fail("program failed");
+    }
+
+    if (Crc32::update(0, (const char *)(uintptr_t)address, length) != crc) {
+        return fail("verify failed");
+    }
+    return true;
+}
+
+/** isValid
+ * @brief	Checks an index record read from flash.
+ * @param	Record
+ * @return  true if intact and pointing inside the region
+ */
+bool ScriptStore::isValid(const ScriptIndex &record) {
+    if (record.magic != SCRIPT_STORE_MAGIC || record.count > SCRIPT_STORE_ENTRIES ||
+        record.check != Crc32::update(0, &record, offsetof(ScriptIndex, check))) {
+        return false;
+    }
+
+    for (size_t ix = 0; ix < record.count; ix++) {
+        const ScriptEntry &entry = record.entries[ix];
+
+        if (entry.offset < dataStart - start || entry.length > end - start - entry.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** readIndex
+ * @brief	Reads the newest intact record of an index sector.
+ * @param	Index sector, 0 or 1
+ * @param	Record to fill
+ * @return  false if there is none
+ */
+bool ScriptStore::readIndex(int which, ScriptIndex &record) {
+    // a record cut short by a reset is skipped
+    for (size_t slot = nextSlot[which]; slot > 0; slot--) {
+        if (flash.read(&record, indexSectors[which] + (slot - 1) * slotSize, sizeof(record)) == 0 &&
+            isValid(record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** writeIndex
+ * @brief	Appends a record to the index, moving to the other sector once full.
+ * @param	New index, its magic, sequence and check get filled in
+ * @return  false if programming failed
+ */
+bool ScriptStore::writeIndex(ScriptIndex &next) {
+    if (nextSlot[current] == slots) {
+        // the full sector keeps the current index until the other one has it
+        int other = 1 - current;
+        if (flash.erase(indexSectors[other], flash.get_sector_size(indexSectors[other])) != 0) {
+            return fail("index erase failed");
+        }
+        nextSlot[other] = 0;
+        current = other;
+    }
+
+    next.magic = SCRIPT_STORE_MAGIC;
+    next.sequence = index.sequence + 1;
+    next.check = Crc32::update(0, &next, offsetof(ScriptIndex, check));
+
+    // programming goes by whole pages
+    char *slot = new char[slotSize];
+    memset(slot, SCRIPT_STORE_ERASED, slotSize);
+    memcpy(slot, &next, sizeof(next));
+
+    int result = flash.program(slot, indexSectors[current] + nextSlot[current] * slotSize, slotSize);
+    delete[] slot;
+
+    // the slot is spoilt either way
+    nextSlot[current]++;
+
+    if (result != 0) {
+        return fail("index program failed");
+    }
+
+    index = next;
+    return true;
+}
+
+/** isEmptySlot
+ * @brief	Tells whether an index slot was never written.
+ * @param	Index sector, 0 or 1
+ * @param	Slot
+ * @return  true if still erased
+ */
+bool ScriptStore::isEmptySlot(int which, size_t slot) {
+    uint32_t magic;
+
+    flash.read(&magic, indexSectors[which] + slot * slotSize, sizeof(magic));
+    return magic == 0xffffffff;
+}
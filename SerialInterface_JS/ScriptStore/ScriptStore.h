@@ -0,0 +1,182 @@
+/**
+ ******************************************************************************
+ * @file    ScriptStore.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Header file for ScriptStore, named programs in flash for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _SCRIPTSTORE_H
+#define _SCRIPTSTORE_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "ScriptFlash.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Size of the flash region, it ends below SCRIPT_STORE_RESERVED unless SCRIPT_STORE_ADDRESS is set.
+ * Both ends are moved down to sector boundaries, the region needs at least four sectors. Left
+ * undefined by default, SCRIPT_STORE_SECTORS whole sectors are used instead (see SCRIPT_FLASH_SIZE). */
+/* #define SCRIPT_STORE_SIZE */
+
+/* Sectors of the region when SCRIPT_STORE_SIZE is not set: two for the index, the rest for programs,
+ * at least two so the programs of one can be moved to the other before it is erased.
+ * Left at the default, the region takes the sectors that fit in SCRIPT_STORE_DEFAULT_LIMIT bytes
+ * and init() fails if that is fewer: set SCRIPT_STORE_SECTORS to opt in to big sectors. */
+#ifndef SCRIPT_STORE_SECTORS
+#define SCRIPT_STORE_SECTORS    4
+#define SCRIPT_STORE_DEFAULT_SECTORS
+#endif
+
+/* Largest region taken without SCRIPT_STORE_SECTORS or SCRIPT_STORE_SIZE set. */
+#ifndef SCRIPT_STORE_DEFAULT_LIMIT
+#define SCRIPT_STORE_DEFAULT_LIMIT  0x10000
+#endif
+
+#if SCRIPT_STORE_SECTORS < 4
+#error "SCRIPT_STORE_SECTORS must be at least 4, two for the index and two for programs"
+#endif
+
+/* Bytes left alone at the end of the flash. Left undefined when ScriptFlash is used there,
+ * the region then ends where that of ScriptFlash starts, whatever its sectors are. */
+#ifndef SCRIPT_STORE_RESERVED
+#if !defined(SERIAL_INTERFACE_SCRIPT_FLASH) || defined(SCRIPT_FLASH_ADDRESS)
+#define SCRIPT_STORE_RESERVED   0
+#endif
+#endif
+
+/* Number of programs the index holds. */
+#ifndef SCRIPT_STORE_ENTRIES
+#define SCRIPT_STORE_ENTRIES    8
+#endif
+
+/* Longest name, including the terminator. */
+#ifndef SCRIPT_STORE_NAME_SIZE
+#define SCRIPT_STORE_NAME_SIZE  16
+#endif
+
+/* Bytes programmed at a time, rounded up to whole pages. */
+#ifndef SCRIPT_STORE_CHUNK
+#define SCRIPT_STORE_CHUNK      64
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+
+/* A stored program, it starts on a page boundary. */
+struct ScriptEntry {
+    char name[SCRIPT_STORE_NAME_SIZE];
+    uint32_t offset;        /* from the start of the region */
+    uint32_t length;        /* bytes of program */
+    uint32_t crc;           /* CRC-32 of the program */
+};
+
+/* The index, two sectors each hold a journal of these. */
+struct ScriptIndex {
+    uint32_t magic;
+    uint32_t sequence;      /* the highest one is current */
+    uint32_t count;
+    ScriptEntry entries[SCRIPT_STORE_ENTRIES];
+    uint32_t check;         /* CRC-32 of the fields above */
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * ScriptStore class which keeps named programs in a flash region. An index
+ * of names, offsets, lengths and CRCs is kept in RAM and journalled to two
+ * sectors in turn, so lookups never scan the flash and an update only counts
+ * once its index record is written. Programs are packed page by page into
+ * erased flash, a new version goes next to the one it replaces. Sectors left
+ * holding only old versions are erased when the room runs out, and the
+ * programs of a sector are moved out first if that is what it takes; one
+ * erased sector is kept spare for them to move to.
+ */
+class ScriptStore {
+public:
+    /* Constructor. */
+    ScriptStore();
+
+    /* Functions. */
+    bool init();
+    bool save(const char *name, const char *code, size_t length);
+    bool find(const char *name, const char *&code, size_t &length);
+    bool remove(const char *name);
+    size_t size();
+    bool get(size_t ix, ScriptEntry &entry);
+    size_t available();
+    const char *getError();
+
+private:
+    bool fail(const char *reason);
+    bool findRegion();
+    int lookup(const char *name);
+    size_t roundToPages(size_t length);
+    bool isUsed(uint32_t address, uint32_t size);
+    bool isErased(uint32_t address, uint32_t size);
+    bool findRoom(size_t length, uint32_t avoid, uint32_t &address);
+    bool allocate(size_t length, uint32_t &address);
+    uint32_t spareSector();
+    bool reclaim(bool &erased);
+    bool compact(bool &moved);
+    bool writeData(uint32_t address, const char *code, size_t length);
+    bool isValid(const ScriptIndex &record);
+    bool readIndex(int which, ScriptIndex &record);
+    bool writeIndex(ScriptIndex &next);
+    bool isEmptySlot(int which, size_t slot);
+
+private:
+    FlashIAP flash;
+    bool ready;
+    const char *error;
+
+    /* Geometry of the region. */
+    uint32_t start;
+    uint32_t end;
+    uint32_t dataStart;
+    uint32_t pageSize;
+
+    /* Index journal, in the first two sectors. */
+    uint32_t indexSectors[2];
+    size_t slotSize;
+    size_t slots;
+    size_t nextSlot[2];
+    int current;
+
+    /* Copy of the current index. */
+    ScriptIndex index;
+};
+
+#endif // _SCRIPTSTORE_H
@@ -43,6 +43,7 @@
  */
 SerialBuffer::SerialBuffer() {
     position = 0;
+    lineStarts.push_back(0);
 }
 
 /** destructor
@@ -58,6 +59,9 @@ SerialBuffer::~SerialBuffer() {
 void SerialBuffer::clear() {
     buffer.clear();
     position = 0;
+
+    lineStarts.clear();
+    lineStarts.push_back(0);
 }
 
 /** add
@@ -65,10 +69,32 @@ void SerialBuffer::clear() {
  * @param	string data
  */
 void SerialBuffer::add(string s) {
-    for(string::iterator it = s.begin(); it != s.end(); ++it) {
-        buffer.insert(buffer.begin() + position, *it);
-        position++;
+    add(s.data(), s.size());
+}
+
+/** add
+ * @brief	Adds characters to buffer in one go.
+ * @param	Characters
+ * @param	Number of characters
+ */
+void SerialBuffer::add(const char *data, size_t length) {
+    buffer.insert(buffer.begin() + position, data, data + length);
+
+    // lines starting after the insertion point move right, new ones go in before them
+    vector<size_t>::iterator it = upper_bound(lineStarts.begin(), lineStarts.end(), position);
+    for (vector<size_t>::iterator shift = it; shift != lineStarts.end(); ++shift) {
+        (*shift) += length;
+    }
+
+    vector<size_t> starts;
+    for (size_t ix = 0; ix < length; ix++) {
+        if (data[ix] == '\n') {
+            starts.push_back(position + ix + 1);
+        }
     }
+    lineStarts.insert(it, starts.begin(), starts.end());
+
+    position += length;
 }
 
 /** add
@@ -77,9 +103,52 @@ void SerialBuffer::add(string s) {
  */
 void SerialBuffer::add(char c) {
     buffer.insert(buffer.begin() + position, c);
+
+    // lines starting after the insertion point move one to the right
+    vector<size_t>::iterator it = upper_bound(lineStarts.begin(), lineStarts.end(), position);
+    for (vector<size_t>::iterator shift = it; shift != lineStarts.end(); ++shift) {
+        (*shift)++;
+    }
+
+    if (c == '\n') {
+        lineStarts.insert(it, position + 1);
+    }
+
     position++;
 }
 
+/** remove
+ * @brief	Removes the character before the position.
+ * @return  Removed character, '\0' if at the start
+ */
+char SerialBuffer::remove() {
+    if (position == 0) return '\0';
+
+    position--;
+    char c = buffer[position];
+    buffer.erase(buffer.begin() + position);
+
+    vector<size_t>::iterator it = upper_bound(lineStarts.begin(), lineStarts.end(), position);
+    if (c == '\n') {
+        it = lineStarts.erase(it);
+    }
+
+    for (vector<size_t>::iterator shift = it; shift != lineStarts.end(); ++shift) {
+        (*shift)--;
+    }
+
+    return c;
+}
+
+/** at
+ * @brief	Returns the character at an offset.
+ * @param	Offset
+ * @return  Character
+ */
+char SerialBuffer::at(size_t pos) {
+    return buffer[pos];
+}
+
 /** begin
  * @brief	Returns the beginning of buffer.
  * @return  buffer begin iterator
@@ -139,3 +208,38 @@ char *SerialBuffer::get_char_array(){
     data[buffer.size()] = '\0';
     return data;
 }
+
+/** lineCount
+ * @brief	Returns the number of lines.
+ * @return  Number of lines, at least 1
+ */
+size_t SerialBuffer::lineCount() {
+    return lineStarts.size();
+}
+
+/** lineOf
+ * @brief	Returns the line an offset is on.
+ * @param	Offset
+ * @return  Line index
+ */
+size_t SerialBuffer::lineOf(size_t pos) {
+    return upper_bound(lineStarts.begin(), lineStarts.end(), pos) - lineStarts.begin() - 1;
+}
+
+/** lineStart
+ * @brief	Returns the offset of the first character of a line.
+ * @param	Line index
+ * @return  Offset
+ */
+size_t SerialBuffer::lineStart(size_t line) {
+    return lineStarts[line];
+}
+
+/** lineEnd
+ * @brief	Returns the offset just past the last character of a line.
+ * @param	Line index
+ * @return  Offset of the line's '\n', or the buffer size for the last line
+ */
+size_t SerialBuffer::lineEnd(size_t line) {
+    return line + 1 < lineStarts.size() ? lineStarts[line + 1] - 1 : buffer.size();
+}
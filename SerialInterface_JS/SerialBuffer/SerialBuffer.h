@@ -45,6 +45,7 @@ using namespace std;
 #include <string>
 #include "mbed.h"
 #include <vector>
+#include <algorithm>
 
 /* Class Declaration ---------------------------------------------------------*/
 
@@ -60,7 +61,10 @@ public:
     /* Functions. */
     void clear();
     void add(string s);
+    void add(const char *data, size_t length);
     void add(char c);
+    char remove();
+    char at(size_t pos);
     vector<char>::iterator begin();
     vector<char>::iterator end();
     size_t getPosition();
@@ -68,6 +72,10 @@ public:
     size_t size();
     string get_string();
     char *get_char_array();
+    size_t lineCount();
+    size_t lineOf(size_t pos);
+    size_t lineStart(size_t line);
+    size_t lineEnd(size_t line);
 
 private:
     /* Buffer. */
@@ -75,6 +83,9 @@ private:
     
     /* Buffer position/index. */
     size_t position;
+
+    /* Offset of the first character of every line, kept sorted. */
+    vector<size_t> lineStarts;
 };
 
 
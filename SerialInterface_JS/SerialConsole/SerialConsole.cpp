@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ * @file    SerialConsole.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of SerialConsole for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <errno.h>
+
+#include "SerialConsole.h"
+
+/* RAW SERIAL ----------------------------------------------------------------*/
+
+extern RawSerial pc;
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ */
+SerialConsole::SerialConsole() : length(0) {
+}
+
+/** getInstance
+ * @brief	Returns the console, created on first use.
+ * @return  Console
+ */
+SerialConsole &SerialConsole::getInstance() {
+    static SerialConsole console;
+    return console;
+}
+
+/** setSink
+ * @brief	Sets where the lines go from now on.
+ * @param	Sink
+ */
+void SerialConsole::setSink(Sink sink) {
+    mutex.lock();
+    this->sink = sink;
+    mutex.unlock();
+}
+
+/** flush
+ * @brief	Hands on what stdout holds and the line written so far, e.g. before a result is printed.
+ */
+void SerialConsole::flush() {
+    fflush(stdout);
+    sync();
+}
+
+/** read
+ * @brief	Reads from the console, the keys all go to the editor.
+ * @param	Buffer
+ * @param	Buffer size
+ * @return  0, end of file
+ */
+ssize_t SerialConsole::read(void *buffer, size_t size) {
+    (void)buffer;
+    (void)size;
+    return 0;
+}
+
+/** write
+ * @brief	Writes to the console.
+ * @param	Data
+ * @param	Data length
+ * @return  Data length
+ */
+ssize_t SerialConsole::write(const void *buffer, size_t size) {
+    const char *data = (const char *)buffer;
+
+    mutex.lock();
+
+    for (size_t ix = 0; ix < size; ix++) {
+        if (!sink) {
+            pc.putc(data[ix]);
+            continue;
+        }
+
+        if (data[ix] == '\n') {
+            // the JerryScript port writes "\r\n", other code just "\n"
+            if (length > 0 && line[length - 1] == '\r') length--;
+            emit();
+            continue;
+        }
+
+        if (length == sizeof(line)) {
+            emit();
+        }
+        line[length++] = data[ix];
+    }
+
+    mutex.unlock();
+    return size;
+}
+
+/** seek
+ * @brief	Seeks, not possible on a console.
+ * @param	Offset
+ * @param	Origin
+ * @return  -ESPIPE
+ */
+off_t SerialConsole::seek(off_t offset, int whence) {
+    (void)offset;
+    (void)whence;
+    return -ESPIPE;
+}
+
+/** close
+ * @brief	Closes the console, it stays open.
+ * @return  0
+ */
+int SerialConsole::close() {
+    return 0;
+}
+
+/** sync
+ * @brief	Hands on the line written so far.
+ * @return  0
+ */
+int SerialConsole::sync() {
+    mutex.lock();
+    if (length > 0) {
+        emit();
+    }
+    mutex.unlock();
+    return 0;
+}
+
+/** isatty
+ * @brief	Tells stdio it is a terminal, so stdout is line buffered.
+ * @return  1
+ */
+int SerialConsole::isatty() {
+    return 1;
+}
+
+/** emit
+ * @brief	Hands the line written so far to the sink, called with the mutex held.
+ */
+void SerialConsole::emit() {
+    sink(line, length);
+    length = 0;
+}
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+namespace mbed {
+
+/** mbed_override_console
+ * @brief	Makes SerialConsole the console of the program.
+ * @param	File descriptor, 0 to 2
+ * @return  Console
+ */
+FileHandle *mbed_override_console(int fd) {
+    (void)fd;
+    return &SerialConsole::getInstance();
+}
+
+} // namespace mbed
+#endif
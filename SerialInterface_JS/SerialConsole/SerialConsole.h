@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ * @file    SerialConsole.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of SerialConsole for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _SERIALCONSOLE_H
+#define _SERIALCONSOLE_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* The console goes through SerialInterface with the editor thread, or as frames. */
+#if defined(SERIAL_INTERFACE_EDITOR_THREAD) || defined(SERIAL_INTERFACE_FRAMED)
+#ifndef SERIAL_INTERFACE_CONSOLE
+#define SERIAL_INTERFACE_CONSOLE
+#endif
+#endif
+
+/* Longest console line held back until its end, longer ones are split. */
+#ifndef SERIAL_CONSOLE_LINE_SIZE
+#define SERIAL_CONSOLE_LINE_SIZE    128
+#endif
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * SerialConsole class, the stdin, stdout and stderr of the program when
+ * SERIAL_INTERFACE_CONSOLE is defined (mbed_override_console(), mbed OS 5.9
+ * and later). JerryScript's print() and the printf()s of other code end up
+ * here. The output is cut into lines, each handed to the sink whole, so that
+ * the editor can be cleared before and repainted after it. Until there is a
+ * sink, output goes straight to the serial port. Not for interrupts.
+ */
+class SerialConsole : public FileHandle {
+public:
+
+    /* Output sink, gets a line without its line break. */
+    typedef Callback<void(const char *, size_t)> Sink;
+
+    /* The console. */
+    static SerialConsole &getInstance();
+
+    /* Functions. */
+    void setSink(Sink sink);
+    void flush();
+
+    /* FileHandle. */
+    virtual ssize_t read(void *buffer, size_t size);
+    virtual ssize_t write(const void *buffer, size_t size);
+    virtual off_t seek(off_t offset, int whence = SEEK_SET);
+    virtual int close();
+    virtual int sync();
+    virtual int isatty();
+
+private:
+    /* Constructor. */
+    SerialConsole();
+
+    void emit();
+
+private:
+    Sink sink;
+    PlatformMutex mutex;
+
+    /* The line written so far. */
+    char line[SERIAL_CONSOLE_LINE_SIZE];
+    size_t length;
+};
+
+#endif // _SERIALCONSOLE_H
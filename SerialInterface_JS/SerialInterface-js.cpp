@@ -45,6 +45,230 @@ void SerialInterface__destructor(uintptr_t native_ptr) {
 
 }
 
+/* Sets a property on a JS object, and releases the value. */
+static void set_property(jerry_value_t object, const char *name, jerry_value_t value) {
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+
+    jerry_release_value(jerry_set_property(object, prop_name, value));
+
+    jerry_release_value(value);
+    jerry_release_value(prop_name);
+}
+
+/* Gets the SerialInterface behind a JS object. */
+static SerialInterface *get_serial_interface(jerry_value_t this_obj) {
+    uintptr_t native_handle;
+    jerry_get_object_native_handle(this_obj, &native_handle);
+
+    return reinterpret_cast<SerialInterface *>(native_handle);
+}
+
+/**
+ * SerialInterface#profile (native JavaScript method)
+ *
+ * @returns Array of the last profiled runs, oldest first. Each one has parse
+ *          and run times (us), code size (bytes), ok, and heap and peak
+ *          (bytes) when JerryScript keeps memory statistics.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, profile) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, profile, (args_count == 0));
+
+    Profiler &profiler = get_serial_interface(this_obj)->getProfiler();
+    ProfileRecord record;
+
+    jerry_value_t runs = jerry_create_array(profiler.size());
+
+    for (size_t ix = 0; profiler.get(ix, record); ix++) {
+        jerry_value_t run = jerry_create_object();
+
+        set_property(run, "parse", jerry_create_number(record.parseTime));
+        set_property(run, "run", jerry_create_number(record.runTime));
+        set_property(run, "code", jerry_create_number(record.codeSize));
+        set_property(run, "ok", jerry_create_boolean(record.ok));
+
+        if (record.heapValid) {
+            set_property(run, "heap", jerry_create_number(record.heapDelta));
+            set_property(run, "peak", jerry_create_number(record.heapPeak));
+        }
+
+        jerry_release_value(jerry_set_property_by_index(runs, ix, run));
+        jerry_release_value(run);
+    }
+
+    return runs;
+}
+
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+/* Copies a JS string out, for the flash calls. */
+static string get_string(jerry_value_t value) {
+    jerry_size_t size = jerry_get_string_size(value);
+    string s(size, '\0');
+
+    if (size) {
+        jerry_string_to_char_buffer(value, (jerry_char_t *)&s[0], size);
+    }
+    return s;
+}
+
+/* Turns a failed ScriptStore call into a JS error. */
+static jerry_value_t script_error(SerialInterface *repl) {
+    return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)repl->getScripts().getError());
+}
+
+/**
+ * SerialInterface#scripts (native JavaScript method)
+ *
+ * @returns Array of the stored programs, each with its name and length (bytes).
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, scripts) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, scripts, (args_count == 0));
+
+    ScriptStore &scripts = get_serial_interface(this_obj)->getScripts();
+    ScriptEntry entry;
+
+    jerry_value_t list = jerry_create_array(scripts.size());
+
+    for (size_t ix = 0; scripts.get(ix, entry); ix++) {
+        jerry_value_t script = jerry_create_object();
+
+        set_property(script, "name", jerry_create_string((const jerry_char_t *)entry.name));
+        set_property(script, "length", jerry_create_number(entry.length));
+
+        jerry_release_value(jerry_set_property_by_index(list, ix, script));
+        jerry_release_value(script);
+    }
+
+    return list;
+}
+
+/**
+ * SerialInterface#save (native JavaScript method)
+ *
+ * @param name Name to store the program under, replacing one of the same name.
+ * @param code Program, the one in the editor if left out.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, save) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, save, (args_count == 1 || args_count == 2));
+    CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, save, 0, string);
+
+    SerialInterface *repl = get_serial_interface(this_obj);
+    string name = get_string(args[0]);
+    bool saved;
+
+    if (args_count == 2) {
+        CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, save, 1, string);
+
+        string code = get_string(args[1]);
+        saved = repl->getScripts().save(name.c_str(), code.data(), code.size());
+    }
+    else {
+        saved = repl->saveScript(name.c_str());
+    }
+
+    return saved ? jerry_create_undefined() : script_error(repl);
+}
+
+/**
+ * SerialInterface#load (native JavaScript method)
+ *
+ * @param name Stored program to put in the editor, replacing what is there.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, load) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, load, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, load, 0, string);
+
+    SerialInterface *repl = get_serial_interface(this_obj);
+    string name = get_string(args[0]);
+
+    return repl->loadScript(name.c_str()) ? jerry_create_undefined() : script_error(repl);
+}
+
+/**
+ * SerialInterface#run (native JavaScript method)
+ *
+ * @param name Stored program to run, straight from flash.
+ * @returns What the program returned.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, run) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, run, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, run, 0, string);
+
+    SerialInterface *repl = get_serial_interface(this_obj);
+    string name = get_string(args[0]);
+    const char *code;
+    size_t length;
+
+    if (!repl->getScripts().find(name.c_str(), code, length)) {
+        return script_error(repl);
+    }
+
+    jerry_value_t parsed_code = jerry_parse(reinterpret_cast<const jerry_char_t *>(code), length, false);
+    if (jerry_value_has_error_flag(parsed_code)) {
+        return parsed_code;
+    }
+
+    jerry_value_t returned_value = jerry_run(parsed_code);
+    jerry_release_value(parsed_code);
+
+    return returned_value;
+}
+
+/**
+ * SerialInterface#remove (native JavaScript method)
+ *
+ * @param name Stored program to remove.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, remove) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, remove, (args_count == 1));
+    CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, remove, 0, string);
+
+    SerialInterface *repl = get_serial_interface(this_obj);
+    string name = get_string(args[0]);
+
+    return repl->getScripts().remove(name.c_str()) ? jerry_create_undefined() : script_error(repl);
+}
+#endif
+
+#ifdef SERIAL_INTERFACE_FRAMED
+/**
+ * SerialInterface#send (native JavaScript method)
+ *
+ * @param data String, or array of byte values, sent as is on the data channel.
+ */
+DECLARE_CLASS_FUNCTION(SerialInterface, send) {
+    CHECK_ARGUMENT_COUNT(SerialInterface, send, (args_count == 1));
+
+    SerialInterface *repl = get_serial_interface(this_obj);
+
+    if (jerry_value_is_string(args[0])) {
+        jerry_size_t size = jerry_get_string_size(args[0]);
+        char *data = new char[size ? size : 1];
+
+        jerry_string_to_char_buffer(args[0], (jerry_char_t *)data, size);
+        repl->sendData(data, size);
+
+        delete[] data;
+        return jerry_create_undefined();
+    }
+
+    CHECK_ARGUMENT_TYPE_ALWAYS(SerialInterface, send, 0, array);
+
+    uint32_t size = jerry_get_array_length(args[0]);
+    char *data = new char[size ? size : 1];
+
+    for (uint32_t ix = 0; ix < size; ix++) {
+        jerry_value_t byte = jerry_get_property_by_index(args[0], ix);
+        data[ix] = jerry_value_is_number(byte) ? (char)(int)jerry_get_number_value(byte) : 0;
+        jerry_release_value(byte);
+    }
+
+    repl->sendData(data, size);
+
+    delete[] data;
+    return jerry_create_undefined();
+}
+#endif
+
 DECLARE_CLASS_CONSTRUCTOR(SerialInterface) {
     CHECK_ARGUMENT_COUNT(SerialInterface, __constructor, (args_count == 0));
 
@@ -55,5 +279,17 @@ DECLARE_CLASS_CONSTRUCTOR(SerialInterface) {
     jerry_value_t js_object = jerry_create_object();
     jerry_set_object_native_handle(js_object, native_ptr, SerialInterface__destructor);
 
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, profile);
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, scripts);
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, save);
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, load);
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, run);
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, remove);
+#endif
+#ifdef SERIAL_INTERFACE_FRAMED
+    ATTACH_CLASS_FUNCTION(js_object, SerialInterface, send);
+#endif
+
     return js_object;
 }
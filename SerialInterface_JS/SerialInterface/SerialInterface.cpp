@@ -47,25 +47,171 @@ ISerialInterface* SerialInterface::serialInterface = NULL;
 /** Constructor
  * @brief	constructor.
  */
-SerialInterface::SerialInterface() : historyPosition(0) {
+SerialInterface::SerialInterface() : printer(ResultPrinter::Sink(this, &SerialInterface::writeResult)), screen(buffer, VirtualScreen::Sink(this, &SerialInterface::write)), historyPosition(0),
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    rxPending(false), rxDropped(0), rxPostFailed(0),
+#endif
+    pasting(false), pasteBracketed(false), pasteEcho(false), pasteStart(0), lastRxTime(0),
+    highlighting(false), profiling(false), txBytes(0)
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    , commanding(false)
+#endif
+#ifdef SERIAL_INTERFACE_FRAMED
+    , mux(ChannelMux::Sink(this, &SerialInterface::transmit)), dropReportPending(false)
+#endif
+    {
     
     //pc.printf("\r\nJavaScript REPL running...\r\n> ");
     
     serialInterface = this;
 
+#if SERIAL_INTERFACE_BRACKETED_PASTE
+    print("\033[?2004h"); // ask the terminal to mark pasted text
+#endif
+
+    querySize();
+
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    editor.start();
+#endif
+
     pc.attach(Callback<void()>(this, &SerialInterface::callback));
 
+#ifdef SERIAL_INTERFACE_FRAMED
+    mux.attach(Callback<void()>(this, &SerialInterface::outputDropped));
+#endif
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+    // what the program prints goes above the editor
+    SerialConsole::getInstance().setSink(SerialConsole::Sink(this, &SerialInterface::writeConsole));
+#endif
+
     jerry_port_console_printing = false;
+
+#ifdef SERIAL_INTERFACE_SCRIPT_FLASH
+    // boot the flashed program once the caller is done
+    js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::runStored));
+#endif
+
+    for (int ix = 0; ix < 2; ix++) {
+        echoKeys[ix] = 0;
+        echoBytes[ix] = 0;
+    }
 }
 
 /** printJustHappened
- * @brief	Prints the character entered.
+ * @brief	Prints the prompt and the program being edited again.
  */
 void SerialInterface::printJustHappened() {
-    string s(buffer.begin(), buffer.end());
-    pc.printf("> %s", s.c_str());
+    // also called by the console port, off the editor thread
+    lock();
+
+    print(SERIAL_INTERFACE_PROMPT);
+    screen.reset(SERIAL_INTERFACE_PROMPT);
+
+    screen.paintFrom(0);
+    screen.moveToOffset(buffer.getPosition());
+
+    unlock();
+}
+
+/** getProfiler
+ * @brief	Gets the profiled runs, for the JavaScript side.
+ * @return  Profiler
+ */
+Profiler &SerialInterface::getProfiler() {
+    return profiler;
+}
+
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+/** getScripts
+ * @brief	Gets the named programs, for the JavaScript side.
+ * @return  ScriptStore
+ */
+ScriptStore &SerialInterface::getScripts() {
+    return scripts;
+}
+
+/** saveScript
+ * @brief	Stores the program being edited under a name.
+ * @param	Name
+ * @return  false if it could not be stored, see getScripts().getError()
+ */
+bool SerialInterface::saveScript(const char *name) {
+    lock();
+
+    // the buffer is contiguous, it goes to flash as is
+    bool saved = scripts.save(name, buffer.size() ? &*buffer.begin() : "", buffer.size());
+
+    unlock();
+    return saved;
 }
 
+/** loadScript
+ * @brief	Replaces the program being edited with a stored one.
+ * @param	Name
+ * @return  false if there is no such program, see getScripts().getError()
+ */
+bool SerialInterface::loadScript(const char *name) {
+    const char *code;
+    size_t length;
+
+    lock();
+
+    bool found = scripts.find(name, code, length);
+    if (found) {
+        replaceBuffer(code, length);
+    }
+
+    unlock();
+    return found;
+}
+#endif
+
+#ifdef SERIAL_INTERFACE_FRAMED
+/** sendData
+ * @brief	Sends binary data from the program on its own channel.
+ * @param	Data
+ * @param	Data length
+ */
+void SerialInterface::sendData(const char *data, size_t length) {
+    mux.send(ChannelMux::DATA, data, length);
+}
+
+/** outputDropped
+ * @brief	Schedules the dropped frames report, called in the interrupt.
+ */
+void SerialInterface::outputDropped() {
+    if (dropReportPending) return;
+
+    dropReportPending = true;
+    js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::reportDropped));
+}
+
+/** reportDropped
+ * @brief	Reports the dropped frames on the log and paints the editor again.
+ */
+void SerialInterface::reportDropped() {
+    lock();
+
+    dropReportPending = false;
+    size_t dropped = mux.takeDropped();
+
+    if (dropped) {
+        screen.moveToOffset(buffer.size());
+        logPrint("\r\n");
+
+        // CHANNEL_MUX_QUEUE_SIZE is too small for what interrupts print
+        logPrint("#output overflow, %lu frames dropped\r\n", (unsigned long)dropped);
+
+        // the dropped frames may have been editor ones
+        screen.redraw();
+    }
+
+    unlock();
+}
+#endif
+
 /** callback
  * @brief	Callback when a key is entered in terminal.
  */
@@ -73,172 +219,437 @@ void SerialInterface::callback() {
     while (pc.readable()) {
         char c = pc.getc();
 
-        // control characters start with 0x1b and end with a-zA-Z
-        if (inControlChar) {
+#ifdef SERIAL_INTERFACE_TRACE
+        trace.record(TraceRecorder::RX, c);
+#endif
 
-            controlSequence.push_back(c);
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+        // handled on the editor thread; if it fell behind, the newest are dropped, not the oldest
+        RxByte rx = { c, us_ticker_read() };
+        if (rxBuffer.full()) {
+            rxDropped++;
+        }
+        else {
+            rxBuffer.push(rx);
+        }
+#else
+        handleInput(c, us_ticker_read());
+#endif
+    }
 
-            // if a-zA-Z then it's the last one in the control char...
-            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
-                inControlChar = false;
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    if (!rxPending) {
+        rxPending = true;
 
-                // up
-                if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x41) {
-                    pc.printf("\033[u"); // restore current position
+        // with the editor queue full the bytes wait in rxBuffer, the next interrupt tries again
+        if (!editor.post(Callback<void()>(this, &SerialInterface::processInput))) {
+            rxPending = false;
+            rxPostFailed++;
+        }
+    }
+#endif
+}
 
-                    if (historyPosition == 0) {
-                        // cannot do...
-                    }
-                    else {
-                        historyPosition--;
-                        // reset cursor to 0, do \r, then write the new command...
-                        pc.printf("\33[2K\r> %s", history[historyPosition].c_str());
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+/** processInput
+ * @brief	Handles the characters received so far, on the editor thread.
+ */
+void SerialInterface::processInput() {
+    RxByte rx;
 
-                        buffer.clear();
-                        buffer.add(history[historyPosition]);
-                    }
-                }
-                // down
-                else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x42) {
-                    pc.printf("\033[u"); // restore current position
-
-                    if (historyPosition == history.size()) {
-                        // no-op
-                    }
-                    else if (historyPosition == history.size() - 1) {
-                        historyPosition++;
-
-                        // put empty
-                        // reset cursor to 0, do \r, then write the new command...
-                        pc.printf("\33[2K\r> ");
-
-                        buffer.clear();
-                    }
-                    else {
-                        historyPosition++;
-                        // reset cursor to 0, do \r, then write the new command...
-                        pc.printf("\33[2K\r> %s", history[historyPosition].c_str());
-
-                        buffer.clear();
-                        buffer.add(history[historyPosition]);
-                    }
+    rxPending = false;
+
+    while (rxBuffer.pop(rx)) {
+        handleInput(rx.c, rx.time);
+    }
+
+    core_util_critical_section_enter();
+    uint32_t dropped = rxDropped;
+    uint32_t delayed = rxPostFailed;
+    rxDropped = 0;
+    rxPostFailed = 0;
+    core_util_critical_section_exit();
+
+    if (dropped || delayed) {
+        screen.moveToOffset(buffer.size());
+        logPrint("\r\n");
+
+        // e.g. a paste while a long result was printed, SERIAL_INTERFACE_RX_BUFFER_SIZE is too small
+        if (dropped) {
+            logPrint("#input overflow, %lu characters dropped\r\n", (unsigned long)dropped);
+        }
+        // EDITOR_THREAD_QUEUE_SIZE is too small
+        if (delayed) {
+            logPrint("#input delayed, editor queue full %lu times\r\n", (unsigned long)delayed);
+        }
+        screen.redraw();
+    }
+}
+#endif
+
+/** handleInput
+ * @brief	Handles a character entered in terminal.
+ * @param	Character
+ * @param	us_ticker time it was received at
+ */
+void SerialInterface::handleInput(char c, uint32_t time) {
+    // snapshot frames are binary, they bypass the editor
+    if (snapshot.isBusy()) {
+        if (snapshot.expired(time)) {
+            if (snapshot.getStatus() == SnapshotLoader::RECEIVING) {
+                print("\r\n#snapshot error timeout\r\n");
+                printJustHappened();
+            }
+            snapshot.release();
+        }
+        else if (receiveSnapshot(c, time)) {
+            return;
+        }
+    }
+
+    // control characters start with 0x1b and end with a-zA-Z or ~
+    if (inControlChar) {
+
+        controlSequence.push_back(c);
+
+        // if a-zA-Z or ~ then it's the last one in the control char...
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '~') {
+            inControlChar = false;
+
+            // bracketed paste start
+            if (controlSequence.size() == 5 && memcmp(&controlSequence[0], "[200~", 5) == 0) {
+                startPaste(true);
+            }
+            // bracketed paste end
+            else if (controlSequence.size() == 5 && memcmp(&controlSequence[0], "[201~", 5) == 0) {
+                finishPaste();
+            }
+            // cursor position report, the answer to querySize()
+            else if (controlSequence.back() == 'R') {
+                unsigned rows = 0;
+
+                // "[<rows>;<columns>R", F3 with modifiers looks alike but with 1 row
+                for (size_t ix = 1; ix < controlSequence.size() && controlSequence[ix] >= '0' && controlSequence[ix] <= '9'; ix++) {
+                    rows = rows * 10 + (controlSequence[ix] - '0');
                 }
-                // left
-                else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x44) {
-                    size_t curr = buffer.getPosition();
-
-                    // at pos0? prevent moving to the left
-                    if (curr == 0) {
-                        pc.printf("\033[u"); // restore current position
-                    }
-                    // otherwise it's OK, move the cursor back
-                    else {
-                        buffer.setPosition(curr - 1);
-
-                        pc.putc('\033');
-                        for (size_t ix = 0; ix < controlSequence.size(); ix++) {
-                            pc.putc(controlSequence[ix]);
-                        }
-                    }
+                screen.setHeight(rows);
+            }
+            // up
+            else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x41) {
+                size_t line = buffer.lineOf(buffer.getPosition());
+
+                // within a multi-line buffer, move up a line
+                if (line > 0) {
+                    moveToLine(line - 1);
                 }
-                // right
-                else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x43) {
-                    size_t curr = buffer.getPosition();
-                    size_t size = buffer.size();
-
-                    // already at the end?
-                    if (curr == size) {
-                        pc.printf("\033[u"); // restore current position
-                    }
-                    else {
-                        buffer.setPosition(curr + 1);
-
-                        pc.putc('\033');
-                        for (size_t ix = 0; ix < controlSequence.size(); ix++) {
-                            pc.putc(controlSequence[ix]);
-                        }
-                    }
+                else if (historyPosition == 0) {
+                    // cannot do...
                 }
                 else {
-                    // not up/down? Execute original control sequence
-                    pc.putc('\033');
-                    for (size_t ix = 0; ix < controlSequence.size(); ix++) {
-                        pc.putc(controlSequence[ix]);
-                    }
+                    historyPosition--;
+                    showHistory();
                 }
+            }
+            // down
+            else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x42) {
+                size_t line = buffer.lineOf(buffer.getPosition());
 
-                controlSequence.clear();
+                // within a multi-line buffer, move down a line
+                if (line + 1 < buffer.lineCount()) {
+                    moveToLine(line + 1);
+                }
+                else if (historyPosition == history.size()) {
+                    // no-op
+                }
+                else {
+                    historyPosition++;
+                    showHistory();
+                }
+            }
+            // left
+            else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x44) {
+                size_t curr = buffer.getPosition();
+
+                // at pos0? prevent moving to the left
+                if (curr != 0) {
+                    buffer.setPosition(curr - 1);
+                    screen.moveToOffset(curr - 1);
+                }
+            }
+            // right
+            else if (controlSequence.size() == 2 && controlSequence.at(0) == 0x5b && controlSequence.at(1) == 0x43) {
+                size_t curr = buffer.getPosition();
+
+                // already at the end?
+                if (curr != buffer.size()) {
+                    buffer.setPosition(curr + 1);
+                    screen.moveToOffset(curr + 1);
+                }
+            }
+            else {
+                // not up/down? Execute original control sequence
+                put('\033');
+                for (size_t ix = 0; ix < controlSequence.size(); ix++) {
+                    put(controlSequence[ix]);
+                }
             }
 
-            continue;
+            controlSequence.clear();
         }
 
-        switch (c) {
-            case 0x06: // '^F': /* Flash the program */
-                pc.printf("\r\n");
-                addCharacter('\0');
-                js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::flashBuffer));
-                break;
-            
-            case 0x12: // '\r': /* want to run the buffer */
-                pc.printf("\r\n");
-                js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::runBuffer));
-                break;
-            case '\r': /* want to run the buffer */
-                addSpecialCharacter('\n');
-                pc.printf("\r\n");
-                break;
-            case 0x09: /* Horizontal Tab */
-                //pc.printf("\t");
-                addCharacter('\t');
-                break;
-            case 0x08: /* backspace */
-            case 0x7f: /* also backspace on some terminals */
-                js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::handleBackspace));
-                break;
-            // Not using ESC key at the moment
-            case 0x1b: // control character 
-                // wait until next a-zA-Z
-                inControlChar = true;
-
-                pc.printf("\033[s"); // save current position
-
-                break; // break out of the callback (ignore all other characters)
-            
-            default:
-                if( c < 0x20){
-                    //pc.printf("Skipping character: %c ASCII: ", c, (int)c);
-                    break;
-                }
-                addCharacter(c);
-                break;
+        return;
+    }
+
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    // a script command line is being typed
+    if (commanding) {
+        commandCharacter(c);
+
+        // an escape sequence ends it, and is handled as usual
+        if (c != 0x1b) return;
+    }
+#endif
+
+    if (isPasteable(c)) {
+        // nobody types that fast, this is a paste
+        if (!pasting && time - lastRxTime < SERIAL_INTERFACE_PASTE_GAP_US) {
+            startPaste(false);
+        }
+        lastRxTime = time;
+
+        if (pasting) {
+            pasteCharacter(c);
+            return;
         }
     }
+    else if (pasting) {
+        finishPaste();
+    }
+
+    switch (c) {
+        case 0x06: // '^F': /* Flash the program */
+            screen.moveToOffset(buffer.size());
+            print("\r\n");
+            addCharacter('\0');
+            js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::flashBuffer));
+            break;
+        
+#ifdef SERIAL_INTERFACE_TRACE
+        case 0x14: // '^T': /* Dump the I/O trace */
+            defer(&SerialInterface::dumpTrace);
+            break;
+#endif
+
+        case 0x02: // '^B': /* Snapshot frame from the host follows */
+            if (snapshot.getStatus() == SnapshotLoader::IDLE) {
+                snapshot.start(time);
+            }
+            break;
+
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+        case 0x0f: // '^O': /* Script command line */
+            startCommand();
+            break;
+#endif
+
+        case 0x0b: // '^K': /* Toggle syntax highlighting */
+            defer(&SerialInterface::toggleHighlight);
+            break;
+
+        case 0x10: // '^P': /* Toggle run profiling */
+            defer(&SerialInterface::toggleProfile);
+            break;
+
+        case 0x12: // '\r': /* want to run the buffer */
+            screen.moveToOffset(buffer.size());
+            print("\r\n");
+            queueRun();
+            break;
+        case '\r': /* want to run the buffer */
+            addSpecialCharacter('\n');
+            break;
+        case 0x09: /* Horizontal Tab */
+            //pc.printf("\t");
+            addCharacter('\t');
+            break;
+        case 0x08: /* backspace */
+        case 0x7f: /* also backspace on some terminals */
+            defer(&SerialInterface::handleBackspace);
+            break;
+        // Not using ESC key at the moment
+        case 0x1b: // control character 
+            // wait until next a-zA-Z
+            inControlChar = true;
+            break; // break out of the callback (ignore all other characters)
+        
+        default:
+            if( c < 0x20){
+                //pc.printf("Skipping character: %c ASCII: ", c, (int)c);
+                break;
+            }
+            addCharacter(c);
+            break;
+    }
+}
+
+/** defer
+ * @brief	Runs editor work outside of the serial interrupt.
+ * @param	Work
+ */
+void SerialInterface::defer(void (SerialInterface::*work)()) {
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    // input is already handled on the editor thread, keep the order
+    (this->*work)();
+#else
+    js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, work));
+#endif
+}
+
+/** lock
+ * @brief	Takes the editor lock before touching editor state off the editor thread.
+ */
+void SerialInterface::lock() {
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    editor.lock();
+#endif
+}
+
+/** unlock
+ * @brief	Releases the editor lock.
+ */
+void SerialInterface::unlock() {
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    editor.unlock();
+#endif
+}
+
+/** isPasteable
+ * @brief	Checks if a character can be part of pasted text.
+ * @param	Character
+ * @return  true for printable characters, Enter and Tab
+ */
+bool SerialInterface::isPasteable(char c) {
+    return (c >= 0x20 && c != 0x7f) || c == '\r' || c == '\t';
+}
+
+/** startPaste
+ * @brief	Stops echoing mid-line, pasted characters go straight into the buffer.
+ * @param	Whether the terminal marks the end of the paste
+ */
+void SerialInterface::startPaste(bool bracketed) {
+    if (pasting) return;
+
+    pasting = true;
+    pasteBracketed = bracketed;
+    pasteStart = buffer.getPosition();
+
+    // appending echoes no more than the paste itself, only an insert is repainted at the end
+    pasteEcho = pasteStart == buffer.size();
+}
+
+/** pasteCharacter
+ * @brief	Adds a pasted character to the buffer, echoed only at the end of the buffer.
+ * @param	Character
+ */
+void SerialInterface::pasteCharacter(char c) {
+    if (pasteEcho) {
+        addToBuffer(c == '\r' ? '\n' : c);
+    }
+    else {
+        buffer.add(c == '\r' ? '\n' : c);
+    }
+
+    if (!pasteBracketed) {
+        // the paste is over once the line goes quiet
+        pasteTimeout.attach_us(Callback<void()>(this, &SerialInterface::pasteTimedOut), SERIAL_INTERFACE_PASTE_GAP_US);
+    }
+}
+
+/** pasteTimedOut
+ * @brief	Called when no character followed a pasted one in time.
+ */
+void SerialInterface::pasteTimedOut() {
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    // with the editor queue full, try again a gap later
+    if (!editor.post(Callback<void()>(this, &SerialInterface::finishPaste))) {
+        pasteTimeout.attach_us(Callback<void()>(this, &SerialInterface::pasteTimedOut), SERIAL_INTERFACE_PASTE_GAP_US);
+    }
+#else
+    // input is handled in the RX interrupt, keep it out while the buffer is painted
+    core_util_critical_section_enter();
+    finishPaste();
+    core_util_critical_section_exit();
+#endif
+}
+
+/** finishPaste
+ * @brief	Redraws everything the paste changed at once.
+ */
+void SerialInterface::finishPaste() {
+    if (!pasting) return;
+
+    pasting = false;
+    pasteTimeout.detach();
+
+    // already on screen
+    if (pasteEcho) return;
+
+    size_t from, to;
+    highlight(pasteStart, buffer.getPosition() - pasteStart, 0, from, to);
+
+    size_t line = buffer.lineOf(pasteStart);
+
+    screen.paintLine(line, pasteStart);
+    screen.paintFrom(line + 1);
+    paintDirty(from, to, pasteStart, buffer.size());
+    screen.moveToOffset(buffer.getPosition());
 }
 
 /** addToBuffer
- * @brief	Add character to Buffer.
+ * @brief	Add character to Buffer and repaint what it moved.
  * @param	Character
  */
 void SerialInterface::addToBuffer(char c){
     size_t curr_pos = buffer.getPosition();
-    size_t buffer_size = buffer.size();
+    size_t line = buffer.lineOf(curr_pos);
+    bool endOfLine = curr_pos == buffer.lineEnd(line);
+    size_t sent = txBytes;
+
+    buffer.add(c);
 
-    if (curr_pos == buffer_size) {
-        buffer.add(c);
+    size_t from, to;
+    highlight(curr_pos, 1, 0, from, to);
+
+    // end of what gets repainted anyway
+    size_t painted;
+
+    if (c == '\n') {
+        // the rest of the line moves to a new row, rows below shift down
+        if (!endOfLine) {
+            screen.clearToEnd();
+        }
+
+        screen.openLine(line + 1);
+
+        if (!endOfLine) {
+            screen.paintLine(line + 1, curr_pos + 1);
+        }
+        painted = buffer.lineEnd(line + 1);
+    }
+    else if (endOfLine && !highlighting) {
+        screen.text(&c, 1);
+        painted = curr_pos + 1;
     }
     else {
-        // super inefficient...
-        string v(buffer.begin(), buffer.end());
-        v.insert(curr_pos, 1, c);
-
-        buffer.clear();
-        buffer.add(v);
+        // only the rest of this row changes
+        screen.paintLine(line, curr_pos, !endOfLine);
+        painted = buffer.lineEnd(line);
+    }
 
-        buffer.setPosition(curr_pos + 1);
+    paintDirty(from, to, curr_pos, painted);
+    screen.moveToOffset(curr_pos + 1);
 
-        pc.printf("\r> %s\033[%dG", v.c_str(), int(curr_pos) + 4);
-    }           
+    countEcho(sent);
 }
 
 /** addCharacter
@@ -247,7 +658,6 @@ void SerialInterface::addToBuffer(char c){
  */
 void SerialInterface::addCharacter(char c){
     addToBuffer(c);
-    pc.putc(c);          
 }
 
 /** addSpecialCharacter
@@ -264,39 +674,230 @@ void SerialInterface::addSpecialCharacter(char c){
 void SerialInterface::handleBackspace() {
     size_t curr_pos = buffer.getPosition();
 
-    string v(buffer.begin(), buffer.end());
+    if (curr_pos == 0) return;
 
-    if (v.size() == 0 || curr_pos == 0) return;
+    size_t line = buffer.lineOf(curr_pos);
+    size_t sent = txBytes;
 
-    bool endOfLine = curr_pos == v.size();
+    if (buffer.remove() == '\n') {
+        // this row joins the one above, rows below shift up
+        screen.closeLine(line);
+        line--;
+    }
 
-    v.erase(curr_pos - 1, 1);
+    size_t from, to;
+    highlight(curr_pos - 1, 0, 1, from, to);
 
-    buffer.clear();
-    buffer.add(v);
+    screen.paintLine(line, curr_pos - 1);
+    paintDirty(from, to, curr_pos - 1, buffer.lineEnd(line));
+    screen.moveToOffset(curr_pos - 1);
 
-    buffer.setPosition(curr_pos - 1);
+    countEcho(sent);
+}
 
-    if (endOfLine) {
-        pc.printf("\b \b");
+/** highlight
+ * @brief	Updates the highlighting after an edit.
+ * @param	Offset of the edit
+ * @param	Number of characters inserted
+ * @param	Number of characters removed
+ * @param	Start of the span to repaint (output)
+ * @param	End of the span to repaint (output)
+ */
+void SerialInterface::highlight(size_t pos, size_t inserted, size_t removed, size_t &from, size_t &to) {
+    if (highlighting) {
+        highlighter.update(buffer, pos, inserted, removed, from, to);
     }
     else {
-        // carriage return, new text, set cursor, empty until end of line
-        pc.printf("\r\033[K> %s\033[%dG", v.c_str(), curr_pos + 2);
+        from = pos;
+        to = pos + inserted;
     }
 }
 
-/** runBuffer
- * @brief	Runs the JS code from buffer.
+/** paintDirty
+ * @brief	Repaints the recoloured span, except what was already repainted.
+ * @param	Start of the recoloured span
+ * @param	End of the recoloured span
+ * @param	Start of what was already repainted
+ * @param	End of what was already repainted
  */
-void SerialInterface::runBuffer() {
+void SerialInterface::paintDirty(size_t from, size_t to, size_t paintedFrom, size_t paintedTo) {
+    if (from < paintedFrom) {
+        screen.paintRange(from, to < paintedFrom ? to : paintedFrom);
+    }
+
+    if (to > paintedTo) {
+        screen.paintRange(from > paintedTo ? from : paintedTo, to);
+    }
+}
+
+/** countEcho
+ * @brief	Accounts the bytes sent to echo a keystroke.
+ * @param	Value of txBytes before the keystroke
+ */
+void SerialInterface::countEcho(size_t sent) {
+    echoKeys[highlighting]++;
+    echoBytes[highlighting] += txBytes - sent;
+}
+
+/** toggleProfile
+ * @brief	Switches run profiling on or off, and lists the runs profiled so far.
+ */
+void SerialInterface::toggleProfile() {
+    ProfileRecord record;
+
+    profiling = !profiling;
+
+    screen.moveToOffset(buffer.size());
+    print("\r\nprofiling %s\r\n", profiling ? "on" : "off");
+
+    for (size_t ix = 0; profiler.get(ix, record); ix++) {
+        printProfile(record);
+    }
+
+    printJustHappened();
+}
+
+/** printProfile
+ * @brief	Prints a profiled run on one line.
+ * @param	Record
+ */
+void SerialInterface::printProfile(const ProfileRecord &record) {
+    print("#profile %s parse %lu us, run %lu us", record.ok ? "ok" : "failed",
+        (unsigned long)record.parseTime, (unsigned long)record.runTime);
+
+    if (record.heapValid) {
+        print(", heap %+ld B, peak %lu B", (long)record.heapDelta, (unsigned long)record.heapPeak);
+    }
+    else {
+        print(", heap -");
+    }
+
+    print(", %lu B of code\r\n", (unsigned long)record.codeSize);
+}
+
+/** toggleHighlight
+ * @brief	Switches syntax highlighting, reports the echo cost of each mode.
+ */
+void SerialInterface::toggleHighlight() {
+    highlighting = !highlighting;
+
+    if (highlighting) {
+        highlighter.rebuild(buffer);
+    }
+    screen.setHighlighter(highlighting ? &highlighter : NULL);
+
+    screen.moveToOffset(buffer.size());
+    print("\r\nhighlighting %s\r\n", highlighting ? "on" : "off");
+
+    for (int ix = 0; ix < 2; ix++) {
+        size_t perKey = echoKeys[ix] ? echoBytes[ix] * 10 / echoKeys[ix] : 0;
+
+        print("%s: %u keys, %u.%u TX bytes/key\r\n", ix ? "highlighted" : "plain",
+            unsigned(echoKeys[ix]), unsigned(perKey / 10), unsigned(perKey % 10));
+    }
+
+    printJustHappened();
+}
+
+/** moveToLine
+ * @brief	Moves the cursor to another line, keeping the column if possible.
+ * @param	Line index
+ */
+void SerialInterface::moveToLine(size_t line) {
+    size_t curr_pos = buffer.getPosition();
+    size_t column = curr_pos - buffer.lineStart(buffer.lineOf(curr_pos));
+    size_t length = buffer.lineEnd(line) - buffer.lineStart(line);
+
+    size_t pos = buffer.lineStart(line) + (column < length ? column : length);
+
+    buffer.setPosition(pos);
+    screen.moveToOffset(pos);
+}
+
+/** showHistory
+ * @brief	Replaces the buffer with the current history entry.
+ */
+void SerialInterface::showHistory() {
+    if (historyPosition < history.size()) {
+        replaceBuffer(history[historyPosition].data(), history[historyPosition].size());
+    }
+    else {
+        replaceBuffer("", 0);
+    }
+}
+
+/** replaceBuffer
+ * @brief	Replaces the buffer and repaints it.
+ * @param	New program
+ * @param	Its length
+ */
+void SerialInterface::replaceBuffer(const char *data, size_t length) {
+    // back to the prompt row, clear the rows the old buffer left on screen
+    screen.clear();
+
+    print(SERIAL_INTERFACE_PROMPT);
+    screen.reset(SERIAL_INTERFACE_PROMPT);
+
+    buffer.clear();
+    buffer.add(data, length);
+
+    if (highlighting) {
+        highlighter.rebuild(buffer);
+    }
+
+    screen.paintFrom(0);
+    screen.moveToOffset(buffer.getPosition());
+}
+
+/** queueRun
+ * @brief	Hands the buffer over to the JavaScript thread, the editor starts afresh.
+ */
+void SerialInterface::queueRun() {
     string rawCode(buffer.begin(), buffer.end());
 
-    // pc.printf("Running: %s\r\n", rawCode.c_str());
+    // the terminal may have been resized since
+    querySize();
 
     history.push_back(rawCode);
     historyPosition = history.size();
 
+    // queued from the RX interrupt (or the editor thread), taken on the event loop
+    core_util_critical_section_enter();
+    pendingRuns.push_back(rawCode);
+    core_util_critical_section_exit();
+
+    buffer.clear();
+    if (highlighting) {
+        highlighter.rebuild(buffer);
+    }
+    screen.reset("");
+
+    js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::runBuffer));
+}
+
+/** querySize
+ * @brief	Asks the terminal how many rows it has, it answers with a cursor position report.
+ */
+void SerialInterface::querySize() {
+#ifndef SERIAL_INTERFACE_FRAMED
+    // as far down as the cursor goes, and back
+    print("\0337\033[999;999H\033[6n\0338");
+#endif
+}
+
+/** runBuffer
+ * @brief	Runs the JS code from buffer.
+ */
+void SerialInterface::runBuffer() {
+    string rawCode;
+
+    core_util_critical_section_enter();
+    rawCode.swap(pendingRuns.front());
+    pendingRuns.pop_front();
+    core_util_critical_section_exit();
+
+    // pc.printf("Running: %s\r\n", rawCode.c_str());
+
     // pc.printf("Executing (%s): ", rawCode.c_str());
     // for (size_t ix = 0; ix < rawCode.size(); ix++) {
     //     pc.printf(" %02x ", rawCode.at(ix));
@@ -306,83 +907,628 @@ void SerialInterface::runBuffer() {
     const jerry_char_t* code = reinterpret_cast<const jerry_char_t*>(rawCode.c_str());
     const size_t length = rawCode.length();
 
+    // toggled from the editor, sample once
+    bool profile = profiling;
+
+    if (profile) {
+        profiler.begin(length);
+    }
+
+    // the editor keeps going while the code parses and runs
     jerry_value_t parsed_code = jerry_parse(code, length, false);
 
+    if (profile) {
+        profiler.parsed();
+    }
+
+    jerry_value_t returned_value = jerry_value_has_error_flag(parsed_code) ? jerry_acquire_value(parsed_code) : jerry_run(parsed_code);
+
+    if (profile) {
+        // Ctrl+P lists the runs on the editor thread
+        lock();
+        profiler.end(!jerry_value_has_error_flag(returned_value));
+        unlock();
+    }
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+    // what the program printed goes above its result
+    SerialConsole::getInstance().flush();
+#endif
+
+    lock();
+
+    // print above whatever was typed in the meantime
+    screen.clear();
+
     // @todo, how do we get the error message? :-o
 
     if (jerry_value_has_error_flag(parsed_code)) {
-        LOG_PRINT_ALWAYS("Syntax error while parsing code... (%s)\r\n", rawCode.c_str());
+        logPrint("Syntax error while parsing code... (%s)\r\n", rawCode.c_str());
+    }
+    else if (jerry_value_has_error_flag(returned_value)) {
+        logPrint("Running failed...\r\n");
+    }
+    else {
+        // reset terminal position to column 0...
+        print("\33[2K\r");
+
+        printResult(returned_value);
+    }
+
+    if (profile) {
+        printProfile(profiler.last());
+    }
+
+    jerry_release_value(returned_value);
+    jerry_release_value(parsed_code);
+
+    resumeEditor();
+    unlock();
+}
+
+/** receiveSnapshot
+ * @brief	Feeds a byte of a snapshot frame to the loader.
+ * @param	Character
+ * @param	us_ticker time it was received at
+ * @return  false if the character turned out not to be part of a frame
+ */
+bool SerialInterface::receiveSnapshot(char c, uint32_t time) {
+    SnapshotLoader::Status status = snapshot.add(c, time);
+
+    if (status == SnapshotLoader::REJECTED) {
+        // the start byte was a stray Ctrl+B, the character is the editor's
+        return false;
+    }
+
+    if (status == SnapshotLoader::FAILED) {
+        // the loader skips the rest of a rejected frame by itself
+        print("\r\n#snapshot error %s\r\n", snapshot.getError());
+        printJustHappened();
+    }
+    else if (status == SnapshotLoader::READY) {
+        js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::runSnapshot));
+    }
+    return true;
+}
+
+/** runSnapshot
+ * @brief	Runs the snapshot (or source) received from the host, and reports how long it took.
+ */
+void SerialInterface::runSnapshot() {
+    char action = snapshot.getAction();
+    size_t size = snapshot.getSize();
+    jerry_value_t returned_value;
+
+    uint32_t start = us_ticker_read();
+
+    if (action == SnapshotLoader::RUN) {
+        // copy the bytecode, the payload is freed below
+        returned_value = jerry_exec_snapshot(snapshot.getData(), size, true);
+    }
+    else {
+        const jerry_char_t* code = reinterpret_cast<const jerry_char_t*>(snapshot.getData());
+
+        jerry_value_t parsed_code = jerry_parse(code, size, false);
+        returned_value = jerry_value_has_error_flag(parsed_code) ? jerry_acquire_value(parsed_code) : jerry_run(parsed_code);
+        jerry_release_value(parsed_code);
+    }
+
+    uint32_t elapsed = us_ticker_read() - start;
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+    SerialConsole::getInstance().flush();
+#endif
+
+    lock();
+
+    screen.clear();
+
+    if (jerry_value_has_error_flag(returned_value)) {
+        print("#snapshot error run failed\r\n");
+    }
+    else {
+        printResult(returned_value);
+
+        // one line the host tool can pick up
+        print("#snapshot ok %c %u %lu\r\n", action, unsigned(size), (unsigned long)elapsed);
+    }
+
+    jerry_release_value(returned_value);
+    snapshot.release();
+
+    resumeEditor();
+    unlock();
+}
+
+/** resumeEditor
+ * @brief	Gives the terminal back to the editor after a run, with the buffer repainted.
+ */
+void SerialInterface::resumeEditor() {
+    print(">\r\n");
+    screen.reset("");
+
+    screen.paintFrom(0);
+    screen.moveToOffset(buffer.getPosition());
+}
+
+#ifdef SERIAL_INTERFACE_SCRIPT_FLASH
+/** runStored
+ * @brief	Runs the program stored by Ctrl+F, straight from flash.
+ */
+void SerialInterface::runStored() {
+    const char *code;
+    size_t length;
+
+    if (!storage.load(code, length, SCRIPT_FLASH_FAST_BOOT)) {
+        return;
+    }
+
+    jerry_value_t parsed_code = jerry_parse(reinterpret_cast<const jerry_char_t*>(code), length, false);
+
+    if (jerry_value_has_error_flag(parsed_code)) {
+        logPrint("Syntax error while parsing the stored program...\r\n");
     }
     else {
         jerry_value_t returned_value = jerry_run(parsed_code);
 
         if (jerry_value_has_error_flag(returned_value)) {
-            LOG_PRINT_ALWAYS("Running failed...\r\n");
+            logPrint("Running the stored program failed...\r\n");
         }
-        else {
-            jerry_value_t str_value = jerry_value_to_string(returned_value);
 
-            jerry_size_t size = jerry_get_string_size(str_value);
-            jerry_char_t ret_buffer[size + 1] = { 0 };
+        jerry_release_value(returned_value);
+    }
 
-            jerry_string_to_char_buffer(str_value, ret_buffer, size);
+    jerry_release_value(parsed_code);
+}
+#endif
 
-            // jerry_string_to_char_buffer is not guaranteed to end with \0
-            ret_buffer[size] = '\0';
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+/** startCommand
+ * @brief	Opens the script command line below the buffer.
+ */
+void SerialInterface::startCommand() {
+    screen.moveToOffset(buffer.size());
+    print("\r\n" SERIAL_INTERFACE_COMMAND_PROMPT);
 
-            // reset terminal position to column 0...
-            pc.printf("\33[2K\r");
-            pc.printf("\33[36m"); // color to cyan
+    commanding = true;
+    command.clear();
+}
 
-            if (jerry_value_is_string(returned_value)) {
-                pc.printf("\"%s\"", ret_buffer);
+/** commandCharacter
+ * @brief	Handles a character typed on the script command line.
+ * @param	Character
+ */
+void SerialInterface::commandCharacter(char c) {
+    switch (c) {
+        case '\r':
+            queueCommand();
+            break;
+
+        case 0x03: // '^C': /* Leave the command line */
+        case 0x1b:
+            commanding = false;
+            print("\r\n");
+            printJustHappened();
+            break;
+
+        case 0x08: /* backspace */
+        case 0x7f: /* also backspace on some terminals */
+            if (!command.empty()) {
+                command.erase(command.size() - 1);
+                print("\b \b");
             }
-            else if (jerry_value_is_array(returned_value)) {
-                pc.printf("[%s]", ret_buffer);
+            break;
+
+        default:
+            if (c >= 0x20 && c < 0x7f && command.size() < SERIAL_INTERFACE_COMMAND_SIZE) {
+                command += c;
+                put(c);
             }
-            else {
-                pc.printf("%s", ret_buffer);
+            break;
+    }
+}
+
+/** queueCommand
+ * @brief	Hands the command line over to the JavaScript thread, which owns the flash.
+ */
+void SerialInterface::queueCommand() {
+    commanding = false;
+    print("\r\n");
+
+    // queued from the RX interrupt (or the editor thread), taken on the event loop
+    core_util_critical_section_enter();
+    pendingCommands.push_back(command);
+    core_util_critical_section_exit();
+
+    // the editor goes on below while the command runs
+    screen.reset("");
+    screen.paintFrom(0);
+    screen.moveToOffset(buffer.getPosition());
+
+    js::EventLoop::getInstance().nativeCallback(Callback<void()>(this, &SerialInterface::runCommand));
+}
+
+/** runCommand
+ * @brief	Runs a script command: save, load, run or remove <name>, or list.
+ */
+void SerialInterface::runCommand() {
+    lock();
+
+    string line;
+
+    core_util_critical_section_enter();
+    line.swap(pendingCommands.front());
+    pendingCommands.pop_front();
+    core_util_critical_section_exit();
+
+    // "<verb> <name>", extra spaces allowed
+    string verb, name;
+    size_t from = line.find_first_not_of(' ');
+    if (from != string::npos) {
+        size_t split = line.find(' ', from);
+        verb = line.substr(from, split - from);
+
+        size_t nameFrom = split == string::npos ? string::npos : line.find_first_not_of(' ', split);
+        if (nameFrom != string::npos) {
+            name = line.substr(nameFrom, line.find_last_not_of(' ') + 1 - nameFrom);
+        }
+    }
+
+    if (verb == "run") {
+        runScript(name.c_str());
+        unlock();
+        return;
+    }
+
+    // print above whatever was typed in the meantime
+    screen.clear();
+
+    const char *code;
+    size_t length;
+
+    if (verb == "save") {
+        if (saveScript(name.c_str())) {
+            print("#script saved %s, %u bytes\r\n", name.c_str(), unsigned(buffer.size()));
+        }
+        else {
+            print("#script error %s\r\n", scripts.getError());
+        }
+    }
+    else if (verb == "load") {
+        if (scripts.find(name.c_str(), code, length)) {
+            // straight from flash, repainted below
+            buffer.clear();
+            buffer.add(code, length);
+            if (highlighting) {
+                highlighter.rebuild(buffer);
             }
 
-            // pc.printf("\r\n");
-            pc.printf("\33[0m"); // color back to normal
-            pc.printf("\r\n");
+            print("#script loaded %s, %u bytes\r\n", name.c_str(), unsigned(length));
+        }
+        else {
+            print("#script error %s\r\n", scripts.getError());
+        }
+    }
+    else if (verb == "remove") {
+        if (scripts.remove(name.c_str())) {
+            print("#script removed %s\r\n", name.c_str());
+        }
+        else {
+            print("#script error %s\r\n", scripts.getError());
+        }
+    }
+    else if (verb == "list") {
+        ScriptEntry entry;
 
-            jerry_release_value(str_value);
+        if (scripts.init()) {
+            for (size_t ix = 0; scripts.get(ix, entry); ix++) {
+                print("#script %s %lu bytes\r\n", entry.name, (unsigned long)entry.length);
+            }
+            print("#script %lu bytes free\r\n", (unsigned long)scripts.available());
+        }
+        else {
+            print("#script error %s\r\n", scripts.getError());
         }
+    }
+    else {
+        print("#script error use save, load, run or remove <name>, or list\r\n");
+    }
 
-        jerry_release_value(returned_value);
+    resumeEditor();
+    unlock();
+}
+
+/** runScript
+ * @brief	Runs a stored program straight from flash, called with the lock held.
+ * @param	Name
+ */
+void SerialInterface::runScript(const char *name) {
+    const char *code;
+    size_t length;
+    jerry_value_t returned_value = 0;
+
+    bool found = scripts.find(name, code, length);
+
+    if (found) {
+        // the editor keeps going while the code parses and runs
+        unlock();
+
+        jerry_value_t parsed_code = jerry_parse(reinterpret_cast<const jerry_char_t*>(code), length, false);
+        returned_value = jerry_value_has_error_flag(parsed_code) ? jerry_acquire_value(parsed_code) : jerry_run(parsed_code);
+        jerry_release_value(parsed_code);
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+        SerialConsole::getInstance().flush();
+#endif
+
+        lock();
     }
 
-    jerry_release_value(parsed_code);
+    screen.clear();
 
-    buffer.clear();
+    if (!found) {
+        print("#script error %s\r\n", scripts.getError());
+    }
+    else if (jerry_value_has_error_flag(returned_value)) {
+        print("#script error %s failed\r\n", name);
+    }
+    else {
+        printResult(returned_value);
+    }
+
+    if (found) {
+        jerry_release_value(returned_value);
+    }
 
-    pc.printf(">\r\n");
+    resumeEditor();
 }
+#endif
 
 /** flashBuffer
  * @brief	Write the data in buffer to flash.
  */
 void SerialInterface::flashBuffer() {
+    // rebooting below, the lock is never given back
+    lock();
+
     addCharacter('\0');
     string rawCode(buffer.begin(), buffer.end());
 
     char *data = (char *)rawCode.c_str();
     //data[buffer.size()] = '\0';
     
-    pc.printf("Requesting to flash: %s\r\nwith length: %i\r\n", data, strlen(data));
+    print("Requesting to flash: ");
+    write(data, strlen(data));
+    print("\r\nwith length: %i\r\n", int(strlen(data)));
+
+#ifdef SERIAL_INTERFACE_SCRIPT_FLASH
+    ScriptFlashStats stats;
+
+    if (!storage.store(data, strlen(data), stats)) {
+        print("Flashing failed: %s\r\n", storage.getError());
+
+        // not rebooting, take the terminators out again
+        while (buffer.getPosition() > 0 && buffer.at(buffer.getPosition() - 1) == '\0') {
+            buffer.remove();
+        }
+        if (highlighting) {
+            highlighter.rebuild(buffer);
+        }
+
+        printJustHappened();
+        unlock();
+        return;
+    }
+
+    print("#flash %lu of %lu sectors written, %lu skipped\r\n",
+        (unsigned long)stats.written, (unsigned long)stats.sectors, (unsigned long)stats.skipped);
+    print("#flash took %lu us", (unsigned long)stats.time);
+    if (stats.written && stats.skipped) {
+        // skipped sectors would have cost about as much as the written ones
+        print(", ~%lu us saved", (unsigned long)((uint64_t)stats.writeTime * stats.skipped / stats.written));
+    }
+    print("\r\n");
+#else
     Flasher::write_to_flash(data);
+#endif
     
     //buffer.clear();
 
-    pc.printf("Rebooting...\r\n");
+    print("Rebooting...\r\n");
 
     // To soft reset device
     NVIC_SystemReset();  
         
 }
 
+#ifdef SERIAL_INTERFACE_TRACE
+/** dumpTrace
+ * @brief	Dumps and clears the I/O trace, one event per line, oldest first.
+ */
+void SerialInterface::dumpTrace() {
+    TraceEvent event;
+
+    // don't record the dump itself
+    trace.setEnabled(false);
+
+    size_t count = trace.size();
+    print("\r\n#trace %u\r\n", unsigned(count));
+
+    for (size_t ix = 0; trace.get(ix, event); ix++) {
+        print("%08lx %c %02x\r\n", (unsigned long)event.time, event.direction, event.data);
+    }
+
+    print("#end\r\n");
+
+    trace.clear();
+    trace.setEnabled(true);
+
+    printJustHappened();
+}
+#endif
+
+/** print
+ * @brief	Formats a message and writes it to the serial port.
+ * @param	Format
+ * @param	Parameters
+ */
+void SerialInterface::print(const char *format, ...) {
+    char message[SERIAL_INTERFACE_PRINT_SIZE];
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (length < 0) return;
+    if (length >= (int)sizeof(message)) length = sizeof(message) - 1;
+
+    write(message, length);
+}
+
+/** logPrint
+ * @brief	Formats an error message and writes it to the log.
+ * @param	Format
+ * @param	Parameters
+ */
+void SerialInterface::logPrint(const char *format, ...) {
+    char message[SERIAL_INTERFACE_PRINT_SIZE];
+
+    va_list args, again;
+    va_start(args, format);
+    va_copy(again, args);
+    int length = vsnprintf(message, sizeof(message), format, args);
+
+    if (length >= (int)sizeof(message)) {
+        // messages can quote the program, they are not cut
+        char *longer = new char[length + 1];
+        vsnprintf(longer, length + 1, format, again);
+        writeLog(longer, length);
+        delete[] longer;
+    }
+    else if (length > 0) {
+        writeLog(message, length);
+    }
+
+    va_end(again);
+    va_end(args);
+}
+
+/** write
+ * @brief	Writes bytes of the editor to the serial port.
+ * @param	Data
+ * @param	Data length
+ */
+void SerialInterface::write(const char *data, size_t length) {
+#ifdef SERIAL_INTERFACE_FRAMED
+    mux.send(ChannelMux::EDITOR, data, length);
+#else
+    transmit(data, length);
+#endif
+}
+
+/** writeResult
+ * @brief	Writes bytes of a result to the serial port.
+ * @param	Data
+ * @param	Data length
+ */
+void SerialInterface::writeResult(const char *data, size_t length) {
+#ifdef SERIAL_INTERFACE_FRAMED
+    mux.send(ChannelMux::STDOUT, data, length);
+#else
+    transmit(data, length);
+#endif
+}
+
+/** writeLog
+ * @brief	Writes bytes of an error message to the serial port.
+ * @param	Data
+ * @param	Data length
+ */
+void SerialInterface::writeLog(const char *data, size_t length) {
+#ifdef SERIAL_INTERFACE_FRAMED
+    mux.send(ChannelMux::LOG, data, length);
+#else
+    transmit(data, length);
+#endif
+}
+
+#ifdef SERIAL_INTERFACE_CONSOLE
+/** writeConsole
+ * @brief	Prints a line the program wrote to the console above the editor.
+ * @param	Line, without line break
+ * @param	Line length
+ */
+void SerialInterface::writeConsole(const char *data, size_t length) {
+#ifdef SERIAL_INTERFACE_FRAMED
+    // on its own channel, the editor needs no clearing or redrawing
+    mux.send(ChannelMux::STDOUT, data, length);
+    mux.send(ChannelMux::STDOUT, "\r\n", 2);
+#else
+    lock();
+
+    // the editor is painted again below the line
+    screen.clear();
+    writeResult(data, length);
+    writeResult("\r\n", 2);
+    screen.redraw();
+
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    if (commanding) {
+        screen.moveToOffset(buffer.size());
+        print("\r\n" SERIAL_INTERFACE_COMMAND_PROMPT "%s", command.c_str());
+    }
+#endif
+
+    unlock();
+#endif
+}
+#endif
+
+/** printResult
+ * @brief	Prints the value a program returned, on a line of its own.
+ * @param	Value
+ */
+void SerialInterface::printResult(jerry_value_t value) {
+#ifdef SERIAL_INTERFACE_FRAMED
+    // the host shows it apart from the editor, no colour needed
+    printer.print(value);
+    writeResult("\r\n", 2);
+#else
+    print("\33[36m"); // color to cyan
+
+    // streamed in chunks, nothing the size of the result ends up on the stack
+    printer.print(value);
+
+    print("\33[0m\r\n"); // color back to normal
+#endif
+}
+
+/** transmit
+ * @brief	Writes bytes to the serial port.
+ * @param	Data
+ * @param	Data length
+ */
+void SerialInterface::transmit(const char *data, size_t length) {
+    txBytes += length;
+
+#ifdef SERIAL_INTERFACE_TRACE
+    trace.record(TraceRecorder::TX, data, length);
+#endif
+
+    for (size_t ix = 0; ix < length; ix++) {
+        pc.putc(data[ix]);
+    }
+}
+
+/** put
+ * @brief	Writes a character to the serial port.
+ * @param	Character
+ */
+void SerialInterface::put(char c) {
+    write(&c, 1);
+}
+
 /** jerry_port_console
  * @brief	Prints to the console.
  * @param	Format
@@ -398,7 +1544,7 @@ void SerialInterface::jerry_port_console (const char *format, /**< format string
         }
 
         if (!jerry_port_console_printing) {
-            pc.printf("\33[100D\33[2K");
+            print("\33[100D\33[2K");
             //jerry_port_console_printing = true;
         }
 
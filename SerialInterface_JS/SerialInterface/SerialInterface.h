@@ -43,6 +43,7 @@
 /* Includes ------------------------------------------------------------------*/
 
 #include <string>
+#include <deque>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -50,16 +51,65 @@
 #include "mbed.h"
 #include "Callback.h"
 
+#include "mbed_critical.h"
 #include "us_ticker_api.h"
 
 #include "Flasher.h"
+#include "ScriptFlash.h"
+#include "ScriptStore.h"
 #include "SerialBuffer.h"
+#include "SerialConsole.h"
+#include "ResultPrinter.h"
+#include "TraceRecorder.h"
+#include "VirtualScreen.h"
+#include "Highlighter.h"
+#include "EditorThread.h"
+#include "SnapshotLoader.h"
+#include "Profiler.h"
+#include "ChannelMux.h"
 #include "ISerialInterface.h"
 
 #include "jerryscript-mbed-event-loop/EventLoop.h"
 
 using namespace std;
 
+/* Limits --------------------------------------------------------------------*/
+
+/* Prompt printed in front of the first line of the buffer. */
+#ifndef SERIAL_INTERFACE_PROMPT
+#define SERIAL_INTERFACE_PROMPT         "> "
+#endif
+
+/* Characters arriving closer than this (in us) are taken as pasted, 0 disables. */
+#ifndef SERIAL_INTERFACE_PASTE_GAP_US
+#define SERIAL_INTERFACE_PASTE_GAP_US   5000
+#endif
+
+/* Whether to enable the terminal's bracketed paste mode. */
+#ifndef SERIAL_INTERFACE_BRACKETED_PASTE
+#define SERIAL_INTERFACE_BRACKETED_PASTE    1
+#endif
+
+/* Characters buffered between the serial interrupt and the editor thread. */
+#ifndef SERIAL_INTERFACE_RX_BUFFER_SIZE
+#define SERIAL_INTERFACE_RX_BUFFER_SIZE 256
+#endif
+
+/* Longest formatted message written by print(), longer ones get cut. */
+#ifndef SERIAL_INTERFACE_PRINT_SIZE
+#define SERIAL_INTERFACE_PRINT_SIZE     64
+#endif
+
+/* Prompt of the script command line (Ctrl+O). */
+#ifndef SERIAL_INTERFACE_COMMAND_PROMPT
+#define SERIAL_INTERFACE_COMMAND_PROMPT "script> "
+#endif
+
+/* Longest script command line. */
+#ifndef SERIAL_INTERFACE_COMMAND_SIZE
+#define SERIAL_INTERFACE_COMMAND_SIZE   48
+#endif
+
 /* RAW SERIAL check ----------------------------------------------------------*/
 #ifndef JSMBED_USE_RAW_SERIAL
 #error "Macro 'JSMBED_USE_RAW_SERIAL' not defined, required by SerialInterface"
@@ -80,6 +130,15 @@ public:
     
     /* Public functions. */
     void printJustHappened();
+    Profiler &getProfiler();
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    ScriptStore &getScripts();
+    bool saveScript(const char *name);
+    bool loadScript(const char *name);
+#endif
+#ifdef SERIAL_INTERFACE_FRAMED
+    void sendData(const char *data, size_t length);
+#endif
 
 private:
     /* SerialInterface interface. */
@@ -87,21 +146,139 @@ private:
     
     /* Functions. */
     void callback();
+    void handleInput(char c, uint32_t time);
+    void defer(void (SerialInterface::*work)());
+    void lock();
+    void unlock();
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    void processInput();
+#endif
     void addToBuffer(char c);
     void addCharacter(char c);
     void addSpecialCharacter(char c);
+    bool isPasteable(char c);
+    void startPaste(bool bracketed);
+    void pasteCharacter(char c);
+    void pasteTimedOut();
+    void finishPaste();
     void handleBackspace();
+    void moveToLine(size_t line);
+    void highlight(size_t pos, size_t inserted, size_t removed, size_t &from, size_t &to);
+    void paintDirty(size_t from, size_t to, size_t paintedFrom, size_t paintedTo);
+    void countEcho(size_t sent);
+    void toggleHighlight();
+    void toggleProfile();
+    void printProfile(const ProfileRecord &record);
+    void showHistory();
+    void replaceBuffer(const char *data, size_t length);
+    void queueRun();
+    void querySize();
     void runBuffer() ;
+    bool receiveSnapshot(char c, uint32_t time);
+    void runSnapshot();
+#ifdef SERIAL_INTERFACE_FRAMED
+    void outputDropped();
+    void reportDropped();
+#endif
+    void resumeEditor();
     void flashBuffer();
+#ifdef SERIAL_INTERFACE_SCRIPT_FLASH
+    void runStored();
+#endif
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    void startCommand();
+    void commandCharacter(char c);
+    void queueCommand();
+    void runCommand();
+    void runScript(const char *name);
+#endif
     bool jerry_port_console_printing;
     void jerry_port_console (const char *format, ...);
+    void print(const char *format, ...);
+    void logPrint(const char *format, ...);
+    void write(const char *data, size_t length);
+    void writeResult(const char *data, size_t length);
+    void writeLog(const char *data, size_t length);
+#ifdef SERIAL_INTERFACE_CONSOLE
+    void writeConsole(const char *data, size_t length);
+#endif
+    void printResult(jerry_value_t value);
+    void transmit(const char *data, size_t length);
+    void put(char c);
+#ifdef SERIAL_INTERFACE_TRACE
+    void dumpTrace();
+#endif
     
 private:
     SerialBuffer buffer;
+    ResultPrinter printer;
+    VirtualScreen screen;
     bool inControlChar = false;
     vector<char> controlSequence;
     vector<string> history;
     size_t historyPosition;
+
+    /* Code waiting for the JavaScript thread, shared with the RX interrupt under a critical section. */
+    deque<string> pendingRuns;
+
+    /* Snapshot sent by the host. */
+    SnapshotLoader snapshot;
+
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    /* Input waiting for the editor thread. */
+    struct RxByte {
+        char c;
+        uint32_t time;
+    };
+    CircularBuffer<RxByte, SERIAL_INTERFACE_RX_BUFFER_SIZE> rxBuffer;
+    volatile bool rxPending;
+
+    /* Characters that found rxBuffer full. */
+    volatile uint32_t rxDropped;
+
+    /* Interrupts that found the editor queue full. */
+    volatile uint32_t rxPostFailed;
+    EditorThread editor;
+#endif
+
+    /* Paste detection. */
+    bool pasting;
+    bool pasteBracketed;
+    bool pasteEcho;         /* appending, echoed as it comes */
+    size_t pasteStart;
+    uint32_t lastRxTime;
+    Timeout pasteTimeout;
+
+    /* Syntax highlighting. */
+    Highlighter highlighter;
+    bool highlighting;
+
+    /* Timings and heap use of the last runs. */
+    Profiler profiler;
+    bool profiling;
+
+    /* Bytes sent, and keystrokes echoed and what they cost per mode. */
+    size_t txBytes;
+    size_t echoKeys[2];
+    size_t echoBytes[2];
+#ifdef SERIAL_INTERFACE_TRACE
+    TraceRecorder trace;
+#endif
+#ifdef SERIAL_INTERFACE_SCRIPT_FLASH
+    ScriptFlash storage;
+#endif
+#ifdef SERIAL_INTERFACE_SCRIPT_STORE
+    /* Named programs, and the command line driving them. */
+    ScriptStore scripts;
+    bool commanding;
+    string command;
+    deque<string> pendingCommands;     /* like pendingRuns */
+#endif
+#ifdef SERIAL_INTERFACE_FRAMED
+    /* Output channels sharing the serial port. */
+    ChannelMux mux;
+    volatile bool dropReportPending;
+#endif
 };
 
 #endif // _SERIALINTERFACE_H
\ No newline at end of file
@@ -0,0 +1,280 @@
+/**
+ ******************************************************************************
+ * @file    SnapshotLoader.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of SnapshotLoader.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "SnapshotLoader.h"
+#include "Crc32.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/* Reads a 32 bit little endian number. */
+static uint32_t readWord(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** Constructor
+ * @brief	constructor.
+ */
+SnapshotLoader::SnapshotLoader() : status(IDLE), error(NULL), lastTime(0),
+    headerCount(0), data(NULL), size(0), count(0), crc(0), skip(0) {
+}
+
+/** start
+ * @brief	Starts receiving a frame, whatever was received before is dropped.
+ * @param	Time of the start byte (us_ticker)
+ */
+void SnapshotLoader::start(uint32_t time) {
+    release();
+
+    status = RECEIVING;
+    lastTime = time;
+}
+
+/** add
+ * @brief	Adds a received byte to the frame.
+ * @param	Character
+ * @param	Time it was received (us_ticker)
+ * @return  RECEIVING (or SKIPPING) while more is expected, then READY or FAILED;
+ *          REJECTED if the character doesn't continue the magic, it is not consumed
+ */
+SnapshotLoader::Status SnapshotLoader::add(char c, uint32_t time) {
+    lastTime = time;
+
+    if (status == SKIPPING) {
+        // a length that can't be trusted leaves only the next magic to go by
+        if (skip == 0) return findMagic(c);
+
+        if (--skip == 0) status = IDLE;
+        return status;
+    }
+
+    if (status != RECEIVING) return status;
+
+    if (headerCount < sizeof(header)) {
+        // no frame after all, e.g. the start byte was typed by accident
+        if (headerCount < 4 && c != "JSNP"[headerCount]) {
+            release();
+            return REJECTED;
+        }
+
+        header[headerCount++] = c;
+
+        if (headerCount == sizeof(header)) {
+            return checkHeader();
+        }
+        return status;
+    }
+
+    ((uint8_t *)data)[count++] = c;
+    crc = Crc32::update(crc, c);
+
+    if (count == size) {
+        return checkPayload();
+    }
+    return status;
+}
+
+/** expired
+ * @brief	Tells whether the host stopped sending in the middle of a frame.
+ * @param	Current time (us_ticker)
+ * @return  true if the frame timed out
+ */
+bool SnapshotLoader::expired(uint32_t time) {
+    return isBusy() && time - lastTime > SNAPSHOT_LOADER_TIMEOUT_US;
+}
+
+/** getStatus
+ * @brief	Gets the transfer status.
+ * @return  Status
+ */
+SnapshotLoader::Status SnapshotLoader::getStatus() {
+    return status;
+}
+
+/** isBusy
+ * @brief	Tells whether received bytes belong to a frame.
+ * @return  true while receiving or skipping
+ */
+bool SnapshotLoader::isBusy() {
+    return status == RECEIVING || status == SKIPPING;
+}
+
+/** getError
+ * @brief	Gets why the transfer failed.
+ * @return  Reason, or NULL
+ */
+const char *SnapshotLoader::getError() {
+    return error;
+}
+
+/** getAction
+ * @brief	Gets what the host wants done with the payload.
+ * @return  RUN or PARSE
+ */
+char SnapshotLoader::getAction() {
+    return header[4];
+}
+
+/** getData
+ * @brief	Gets the received payload, valid until release().
+ * @return  Payload
+ */
+const uint32_t *SnapshotLoader::getData() {
+    return data;
+}
+
+/** getSize
+ * @brief	Gets the payload size.
+ * @return  Size in bytes
+ */
+size_t SnapshotLoader::getSize() {
+    return size;
+}
+
+/** release
+ * @brief	Frees the payload and goes back to idle.
+ */
+void SnapshotLoader::release() {
+    delete[] data;
+
+    data = NULL;
+    size = 0;
+    count = 0;
+    crc = 0;
+    headerCount = 0;
+    skip = 0;
+    error = NULL;
+    status = IDLE;
+}
+
+/** fail
+ * @brief	Drops the payload and remembers why.
+ * @param	Reason
+ * @param	Bytes of the frame still to come
+ * @return  FAILED, the loader itself moves on to SKIPPING or IDLE
+ */
+SnapshotLoader::Status SnapshotLoader::fail(const char *reason, size_t skip) {
+    delete[] data;
+    data = NULL;
+
+    error = reason;
+    this->skip = skip;
+    status = skip ? SKIPPING : IDLE;
+    return FAILED;
+}
+
+/** resync
+ * @brief	Drops a frame whose length is out of range, and what follows up to the next magic.
+ * @param	Reason
+ * @return  FAILED, the loader itself moves on to SKIPPING
+ */
+SnapshotLoader::Status SnapshotLoader::resync(const char *reason) {
+    fail(reason, 0);
+
+    headerCount = 0;
+    status = SKIPPING;
+    return FAILED;
+}
+
+/** findMagic
+ * @brief	Looks for the magic of the next frame while resyncing.
+ * @param	Character
+ * @return  SKIPPING, or RECEIVING once the magic is complete
+ */
+SnapshotLoader::Status SnapshotLoader::findMagic(char c) {
+    // no byte of "JSNP" but the first is a 'J', so a mismatch starts over
+    headerCount = c == "JSNP"[headerCount] ? headerCount + 1 : (c == 'J' ? 1 : 0);
+
+    if (headerCount == 4) {
+        memcpy(header, "JSNP", 4);
+        error = NULL;
+        status = RECEIVING;
+    }
+    return status;
+}
+
+/** checkHeader
+ * @brief	Validates the frame header and makes room for the payload.
+ * @return  RECEIVING, or FAILED
+ */
+SnapshotLoader::Status SnapshotLoader::checkHeader() {
+    char action = getAction();
+    uint32_t version = readWord(header + 8);
+
+    size = readWord(header + 12);
+
+    // skipping a length from a damaged header could swallow gigabytes
+    if (size == 0 || size > SNAPSHOT_LOADER_MAX_SIZE) {
+        return resync("bad size");
+    }
+    if (action != RUN && action != PARSE) {
+        return fail("unknown action", size);
+    }
+    if (action == RUN && version != SNAPSHOT_LOADER_VERSION) {
+        return fail("version mismatch", size);
+    }
+    if (action == RUN && size % 4 != 0) {
+        return fail("unaligned snapshot", size);
+    }
+
+    data = new (std::nothrow) uint32_t[(size + 3) / 4];
+    if (!data) {
+        return fail("out of memory", size);
+    }
+
+    return status;
+}
+
+/** checkPayload
+ * @brief	Validates the received payload against the header.
+ * @return  READY, or FAILED
+ */
+SnapshotLoader::Status SnapshotLoader::checkPayload() {
+    if (crc != readWord(header + 16)) {
+        return fail("crc mismatch", 0);
+    }
+
+    // the snapshot's own header starts with the version it was made for
+    if (getAction() == RUN && data[0] != SNAPSHOT_LOADER_VERSION) {
+        return fail("version mismatch", 0);
+    }
+
+    status = READY;
+    return status;
+}
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ * @file    SnapshotLoader.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Receives JerryScript snapshots sent by the host.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _SNAPSHOTLOADER_H
+#define _SNAPSHOTLOADER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <new>
+
+#include "mbed.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Snapshot format this firmware runs, JERRY_SNAPSHOT_VERSION of the linked JerryScript. */
+#ifndef SNAPSHOT_LOADER_VERSION
+#define SNAPSHOT_LOADER_VERSION     6
+#endif
+
+/* Largest payload accepted, in bytes. */
+#ifndef SNAPSHOT_LOADER_MAX_SIZE
+#define SNAPSHOT_LOADER_MAX_SIZE    16384
+#endif
+
+/* A transfer is dropped when no byte arrives for this long (in us). */
+#ifndef SNAPSHOT_LOADER_TIMEOUT_US
+#define SNAPSHOT_LOADER_TIMEOUT_US  1000000
+#endif
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * SnapshotLoader class which receives a framed payload from the host:
+ *
+ *   "JSNP", action, 3 reserved bytes, version, length, CRC-32 of the payload
+ *
+ * followed by length bytes of payload, all numbers 32 bit little endian. The
+ * action is RUN for a snapshot made with the host JerryScript, or PARSE for
+ * plain source (to compare load times on the same script). When a header is
+ * rejected the announced payload is skipped, so it never reaches the editor;
+ * if the length itself is out of range, everything up to the magic of the
+ * next frame (or a second of quiet) is.
+ * The magic is checked byte by byte: the first byte that doesn't match ends
+ * the transfer as REJECTED and belongs to the editor, so a start byte typed
+ * by accident costs no keystrokes.
+ */
+class SnapshotLoader {
+public:
+    enum Action {
+        RUN = 'R',
+        PARSE = 'P'
+    };
+
+    enum Status {
+        IDLE,
+        RECEIVING,
+        SKIPPING,
+        READY,
+        FAILED,
+        REJECTED
+    };
+
+    /* Constructor. */
+    SnapshotLoader();
+
+    /* Functions. */
+    void start(uint32_t time);
+    Status add(char c, uint32_t time);
+    bool expired(uint32_t time);
+    Status getStatus();
+    bool isBusy();
+    const char *getError();
+    char getAction();
+    const uint32_t *getData();
+    size_t getSize();
+    void release();
+
+private:
+    Status fail(const char *reason, size_t skip);
+    Status resync(const char *reason);
+    Status findMagic(char c);
+    Status checkHeader();
+    Status checkPayload();
+
+private:
+    volatile Status status;
+    const char *error;
+    uint32_t lastTime;
+
+    /* Frame header as received. */
+    uint8_t header[20];
+    size_t headerCount;
+
+    /* Payload, word aligned as jerry_exec_snapshot wants it. */
+    uint32_t *data;
+    size_t size;
+    size_t count;
+    uint32_t crc;
+
+    /* Bytes of a rejected frame still to come, 0 while SKIPPING up to the next magic. */
+    size_t skip;
+};
+
+#endif // _SNAPSHOTLOADER_H
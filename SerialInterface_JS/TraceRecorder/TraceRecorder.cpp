@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * @file    TraceRecorder.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of TraceRecorder for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "TraceRecorder.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ */
+TraceRecorder::TraceRecorder() : head(0), count(0), enabled(true) {
+}
+
+/** record
+ * @brief	Records a byte, safe to call from the serial interrupt.
+ * @param	Direction
+ * @param	Character
+ */
+void TraceRecorder::record(Direction direction, char c) {
+    if (!enabled) return;
+
+    uint32_t now = us_ticker_read();
+
+    core_util_critical_section_enter();
+
+    events[head].time = now;
+    events[head].direction = direction;
+    events[head].data = c;
+
+    head = (head + 1) % TRACE_RECORDER_EVENTS;
+    if (count < TRACE_RECORDER_EVENTS) count++;
+
+    core_util_critical_section_exit();
+}
+
+/** record
+ * @brief	Records a run of bytes, all with the same timestamp.
+ * @param	Direction
+ * @param	Data
+ * @param	Data length
+ */
+void TraceRecorder::record(Direction direction, const char *data, size_t length) {
+    if (!enabled) return;
+
+    uint32_t now = us_ticker_read();
+
+    core_util_critical_section_enter();
+
+    for (size_t ix = 0; ix < length; ix++) {
+        events[head].time = now;
+        events[head].direction = direction;
+        events[head].data = data[ix];
+
+        head = (head + 1) % TRACE_RECORDER_EVENTS;
+    }
+
+    count = count + length > TRACE_RECORDER_EVENTS ? TRACE_RECORDER_EVENTS : count + length;
+
+    core_util_critical_section_exit();
+}
+
+/** setEnabled
+ * @brief	Pauses or resumes recording.
+ * @param	Whether to record
+ */
+void TraceRecorder::setEnabled(bool enabled) {
+    this->enabled = enabled;
+}
+
+/** isEnabled
+ * @brief	Returns whether recording is on.
+ * @return  true if recording
+ */
+bool TraceRecorder::isEnabled() {
+    return enabled;
+}
+
+/** size
+ * @brief	Returns the number of events in the ring.
+ * @return  Number of events
+ */
+size_t TraceRecorder::size() {
+    return count;
+}
+
+/** get
+ * @brief	Reads an event, index 0 being the oldest one.
+ * @param	Index
+ * @param	Event to fill in
+ * @return  false if the index is out of range
+ */
+bool TraceRecorder::get(size_t index, TraceEvent &event) {
+    core_util_critical_section_enter();
+
+    bool valid = index < count;
+    if (valid) {
+        event = events[(head + TRACE_RECORDER_EVENTS - count + index) % TRACE_RECORDER_EVENTS];
+    }
+
+    core_util_critical_section_exit();
+
+    return valid;
+}
+
+/** clear
+ * @brief	Drops all recorded events.
+ */
+void TraceRecorder::clear() {
+    core_util_critical_section_enter();
+    head = 0;
+    count = 0;
+    core_util_critical_section_exit();
+}
@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @file    TraceRecorder.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of TraceRecorder for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _TRACERECORDER_H
+#define _TRACERECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "mbed_critical.h"
+#include "us_ticker_api.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Number of events kept in the ring, oldest ones get overwritten. */
+#ifndef TRACE_RECORDER_EVENTS
+#define TRACE_RECORDER_EVENTS   512
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+
+/* One byte crossing the serial port. */
+struct TraceEvent {
+    uint32_t time;      /* us_ticker timestamp */
+    uint8_t direction;  /* TraceRecorder::RX or TraceRecorder::TX */
+    uint8_t data;
+};
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * TraceRecorder class which logs every RX and TX byte with its timestamp
+ * into a fixed RAM ring.
+ */
+class TraceRecorder {
+public:
+    enum Direction {
+        RX = 'R',
+        TX = 'T'
+    };
+
+    /* Constructor. */
+    TraceRecorder();
+
+    /* Functions. */
+    void record(Direction direction, char c);
+    void record(Direction direction, const char *data, size_t length);
+    void setEnabled(bool enabled);
+    bool isEnabled();
+    size_t size();
+    bool get(size_t index, TraceEvent &event);
+    void clear();
+
+private:
+    TraceEvent events[TRACE_RECORDER_EVENTS];
+
+    /* Index of the next event to write. */
+    size_t head;
+    size_t count;
+    volatile bool enabled;
+};
+
+#endif // _TRACERECORDER_H
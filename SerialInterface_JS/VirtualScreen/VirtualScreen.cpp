@@ -0,0 +1,497 @@
+/**
+ ******************************************************************************
+ * @file    VirtualScreen.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of VirtualScreen for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "VirtualScreen.h"
+
+/* Class Implementation ------------------------------------------------------*/
+
+/** Constructor
+ * @brief	constructor.
+ * @param	Buffer shown on screen
+ * @param	Sink the escape sequences and text are written to
+ */
+VirtualScreen::VirtualScreen(SerialBuffer &buffer, Sink out) : buffer(buffer), out(out), height(VIRTUAL_SCREEN_ROWS), highlighter(NULL) {
+    reset("");
+}
+
+/** reset
+ * @brief	Starts a new buffer on the row the cursor is on.
+ * @param	Prompt already printed in front of the first line
+ */
+void VirtualScreen::reset(const char *prompt) {
+    this->prompt = prompt;
+    origin = strlen(prompt);
+    row = 0;
+    column = origin;
+    rows = 1;
+
+    // whatever was printed above, the bottom row is the safe guess
+    screenRow = height - 1;
+}
+
+/** setHeight
+ * @brief	Sets the number of terminal rows, e.g. as reported by the terminal.
+ * @param	Rows, less than 2 is ignored
+ */
+void VirtualScreen::setHeight(size_t height) {
+    if (height < 2) return;
+
+    this->height = height;
+
+    if (screenRow >= height) {
+        screenRow = height - 1;
+    }
+    if (rows > lastVisible() + 1) {
+        rows = lastVisible() + 1;
+    }
+}
+
+/** setHighlighter
+ * @brief	Sets the highlighter used to colour painted text.
+ * @param	Highlighter, NULL for plain text
+ */
+void VirtualScreen::setHighlighter(Highlighter *highlighter) {
+    this->highlighter = highlighter;
+}
+
+/** getRow
+ * @brief	Returns the cursor row.
+ * @return  Row, relative to the first row of the buffer
+ */
+size_t VirtualScreen::getRow() {
+    return row;
+}
+
+/** getColumn
+ * @brief	Returns the cursor column.
+ * @return  Column, 0 based
+ */
+size_t VirtualScreen::getColumn() {
+    return column;
+}
+
+/** columnOf
+ * @brief	Returns the screen column of a buffer offset.
+ * @param	Offset
+ * @return  Column, 0 based
+ */
+size_t VirtualScreen::columnOf(size_t pos) {
+    size_t line = buffer.lineOf(pos);
+    size_t col = line == 0 ? origin : 0;
+
+    for (size_t ix = buffer.lineStart(line); ix < pos; ix++) {
+        col = advance(col, buffer.at(ix));
+    }
+
+    return col;
+}
+
+/** moveTo
+ * @brief	Moves the cursor, scrolling the row into view when needed.
+ * @param	Row
+ * @param	Column
+ */
+void VirtualScreen::moveTo(size_t row, size_t column) {
+    if (row < firstVisible()) {
+        // cursor up stops at the top of the screen, bring the row back half a screen down
+        repaint(row > height / 2 ? row - height / 2 : 0);
+    }
+    else if (row >= rows) {
+        reveal(row);
+    }
+
+    moveToRow(row);
+
+    if (column + 1 == this->column) {
+        out("\b", 1);
+    }
+    else if (column != this->column) {
+        command("\033[%uG", column + 1);
+    }
+    this->column = column;
+}
+
+/** moveToOffset
+ * @brief	Moves the cursor to where a buffer offset is displayed.
+ * @param	Offset
+ */
+void VirtualScreen::moveToOffset(size_t pos) {
+    moveTo(buffer.lineOf(pos), columnOf(pos));
+}
+
+/** text
+ * @brief	Writes text without line breaks at the cursor.
+ * @param	Data
+ * @param	Data length
+ */
+void VirtualScreen::text(const char *data, size_t length) {
+    size_t run = 0;
+
+    for (size_t ix = 0; ix < length; ix++) {
+        if (data[ix] != '\t') continue;
+
+        if (ix > run) {
+            out(data + run, ix - run);
+            column += ix - run;
+        }
+
+        // tabs only move the cursor, spaces overwrite what was there
+        size_t next = advance(column, '\t');
+        while (column < next) {
+            out(" ", 1);
+            column++;
+        }
+
+        run = ix + 1;
+    }
+
+    if (length > run) {
+        out(data + run, length - run);
+        column += length - run;
+    }
+}
+
+/** newLine
+ * @brief	Moves to the start of the next row, scrolling if needed.
+ */
+void VirtualScreen::newLine() {
+    out("\r\n", 2);
+    row++;
+    column = 0;
+
+    if (screenRow + 1 < height) screenRow++;
+    if (row >= rows) rows = row + 1;
+}
+
+/** clearToEnd
+ * @brief	Clears from the cursor to the end of the row.
+ */
+void VirtualScreen::clearToEnd() {
+    out("\033[K", 3);
+}
+
+/** clearBelow
+ * @brief	Clears from the cursor to the end of the screen.
+ */
+void VirtualScreen::clearBelow() {
+    out("\033[J", 3);
+    rows = row + 1;
+}
+
+/** clear
+ * @brief	Clears the rows of the buffer still on screen, from the start of the first one.
+ */
+void VirtualScreen::clear() {
+    // rows that scrolled off the top are out of reach
+    moveTo(firstVisible(), 0);
+    clearBelow();
+}
+
+/** redraw
+ * @brief	Paints the prompt and the buffer again from the row the cursor is on, e.g. after output above them.
+ */
+void VirtualScreen::redraw() {
+    reset(prompt);
+    out(prompt, origin);
+
+    paintFrom(0);
+    moveToOffset(buffer.getPosition());
+}
+
+/** openLine
+ * @brief	Inserts an empty row, pushing the rows below it down.
+ * @param	Row
+ */
+void VirtualScreen::openLine(size_t row) {
+    if (row >= rows) {
+        reveal(row - 1);
+
+        if (row >= rows) {
+            moveToRow(rows - 1);
+            newLine();
+        }
+        moveTo(row, 0);
+        return;
+    }
+
+    moveTo(row, 0);
+    out("\033[L", 3);
+
+    // the bottom row is pushed off the screen
+    rows = rows <= lastVisible() ? rows + 1 : lastVisible() + 1;
+}
+
+/** closeLine
+ * @brief	Deletes a row, pulling the rows below it up.
+ * @param	Row
+ */
+void VirtualScreen::closeLine(size_t row) {
+    if (row >= rows) return;
+
+    moveTo(row, 0);
+    out("\033[M", 3);
+    if (rows > 1) rows--;
+
+    // the bottom row came up empty, fill it if the buffer goes on
+    if (rows == lastVisible() && rows < buffer.lineCount()) {
+        reveal(rows);
+    }
+}
+
+/** paintLine
+ * @brief	Repaints a line from an offset to its end.
+ * @param	Line index
+ * @param	Offset to start from
+ * @param	Whether to clear what's left of the row
+ */
+void VirtualScreen::paintLine(size_t line, size_t from, bool clear) {
+    if (line < firstVisible() || line >= windowEnd()) {
+        // off screen, painted once scrolled to
+        return;
+    }
+
+    if (line >= rows) {
+        // new rows are painted whole
+        reveal(line);
+        return;
+    }
+
+    size_t end = buffer.lineEnd(line);
+
+    moveTo(line, columnOf(from));
+
+    if (end > from) {
+        paintSegment(from, end);
+    }
+
+    if (clear) {
+        clearToEnd();
+    }
+}
+
+/** paintFrom
+ * @brief	Repaints every line on screen from the given one down.
+ * @param	Line index
+ */
+void VirtualScreen::paintFrom(size_t line) {
+    for (size_t ix = line; ix < buffer.lineCount() && ix < windowEnd(); ix++) {
+        paintLine(ix, buffer.lineStart(ix));
+    }
+}
+
+/** paintRange
+ * @brief	Repaints a span of the buffer whose width didn't change.
+ * @param	Start offset
+ * @param	End offset
+ */
+void VirtualScreen::paintRange(size_t from, size_t to) {
+    while (from < to) {
+        size_t line = buffer.lineOf(from);
+
+        if (line < firstVisible()) {
+            from = buffer.lineStart(firstVisible());
+            continue;
+        }
+        if (line >= windowEnd()) {
+            break;
+        }
+
+        size_t end = buffer.lineEnd(line);
+        if (end > to) end = to;
+
+        if (line >= rows) {
+            reveal(line);
+        }
+        else if (end > from) {
+            moveTo(line, columnOf(from));
+            paintSegment(from, end);
+        }
+
+        // skip the line break
+        from = end + 1;
+    }
+}
+
+/** firstVisible
+ * @brief	Returns the first row of the buffer on screen.
+ * @return  Row
+ */
+size_t VirtualScreen::firstVisible() {
+    return row > screenRow ? row - screenRow : 0;
+}
+
+/** lastVisible
+ * @brief	Returns the row of the buffer on the bottom row of the screen.
+ * @return  Row, may be past the end of the buffer
+ */
+size_t VirtualScreen::lastVisible() {
+    return row + (height - 1 - screenRow);
+}
+
+/** windowEnd
+ * @brief	Returns the end of the rows that fit on screen with the first visible one.
+ * @return  Row
+ */
+size_t VirtualScreen::windowEnd() {
+    return firstVisible() + height;
+}
+
+/** moveToRow
+ * @brief	Moves the cursor up or down to a row on screen.
+ * @param	Row
+ */
+void VirtualScreen::moveToRow(size_t row) {
+    if (row < this->row) {
+        command("\033[%uA", this->row - row);
+        screenRow -= this->row - row;
+    }
+    else if (row > this->row) {
+        command("\033[%uB", row - this->row);
+        screenRow += row - this->row;
+    }
+    this->row = row;
+}
+
+/** reveal
+ * @brief	Paints the rows below the buffer's last one down to a row, scrolling if needed.
+ * @param	Row
+ */
+void VirtualScreen::reveal(size_t row) {
+    if (row >= rows + height) {
+        // scrolling through would paint more than a screen
+        repaint(row + 1 - height);
+        return;
+    }
+
+    // cursor down doesn't scroll, new rows have to be printed
+    while (rows <= row) {
+        moveToRow(rows - 1);
+        newLine();
+
+        if (this->row < buffer.lineCount()) {
+            paintSegment(buffer.lineStart(this->row), buffer.lineEnd(this->row));
+        }
+    }
+}
+
+/** repaint
+ * @brief	Clears the screen and paints the buffer from a row at the top.
+ * @param	Row
+ */
+void VirtualScreen::repaint(size_t first) {
+    size_t end = first + height;
+    if (end > buffer.lineCount()) end = buffer.lineCount();
+
+    out("\033[H\033[J", 6);
+    row = first;
+    column = 0;
+    rows = first + 1;
+    screenRow = 0;
+
+    for (size_t line = first; line < end; line++) {
+        if (line > first) {
+            newLine();
+        }
+        if (line == 0) {
+            text(prompt, origin);
+        }
+        paintSegment(buffer.lineStart(line), buffer.lineEnd(line));
+    }
+}
+
+/** paintSegment
+ * @brief	Writes part of a line at the cursor, coloured if highlighting.
+ * @param	Start offset
+ * @param	End offset, not past the end of the line
+ */
+void VirtualScreen::paintSegment(size_t from, size_t to) {
+    if (!highlighter) {
+        text(&*(buffer.begin() + from), to - from);
+        return;
+    }
+
+    const char *current = NULL;
+
+    while (from < to) {
+        size_t end;
+        const char *color = Highlighter::color(highlighter->typeAt(buffer, from, end));
+        if (end > to) end = to;
+
+        if (color != current) {
+            if (color) out(color, strlen(color));
+            else out("\033[0m", 4);
+            current = color;
+        }
+
+        text(&*(buffer.begin() + from), end - from);
+        from = end;
+    }
+
+    if (current) {
+        out("\033[0m", 4);
+    }
+}
+
+/** command
+ * @brief	Writes an escape sequence with one numeric parameter.
+ * @param	Format
+ * @param	Parameter
+ */
+void VirtualScreen::command(const char *format, unsigned value) {
+    char sequence[16];
+    int length = snprintf(sequence, sizeof(sequence), format, value);
+
+    if (length > 0 && length < (int)sizeof(sequence)) {
+        out(sequence, length);
+    }
+}
+
+/** advance
+ * @brief	Returns the column after printing a character.
+ * @param	Column
+ * @param	Character
+ * @return  New column
+ */
+size_t VirtualScreen::advance(size_t column, char c) {
+    if (c == '\t') {
+        return (column / VIRTUAL_SCREEN_TAB_WIDTH + 1) * VIRTUAL_SCREEN_TAB_WIDTH;
+    }
+    return column + 1;
+}
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ * @file    VirtualScreen.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Implementation of VirtualScreen for SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _VIRTUALSCREEN_H
+#define _VIRTUALSCREEN_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "mbed.h"
+#include "SerialBuffer.h"
+#include "Highlighter.h"
+
+/* Limits --------------------------------------------------------------------*/
+
+/* Tab stops of the terminal. */
+#ifndef VIRTUAL_SCREEN_TAB_WIDTH
+#define VIRTUAL_SCREEN_TAB_WIDTH    8
+#endif
+
+/* Terminal rows assumed until the terminal reports its size. */
+#ifndef VIRTUAL_SCREEN_ROWS
+#define VIRTUAL_SCREEN_ROWS         24
+#endif
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * VirtualScreen class which keeps track of where the terminal cursor is
+ * relative to the first row of the buffer, so that only the rows touched
+ * by an edit need to be repainted. Lines are assumed to fit the terminal
+ * width.
+ *
+ * Buffers can be taller than the terminal, so it also keeps track of the
+ * rows on screen. Cursor movements are clamped at the screen edges: rows
+ * below are brought in by scrolling, rows that scrolled off the top by
+ * repainting the screen. Where the buffer starts on screen is unknown, it
+ * is taken to start on the bottom row, which never places a row higher
+ * up than it really is.
+ */
+class VirtualScreen {
+public:
+
+    /* Output sink. */
+    typedef Callback<void(const char *, size_t)> Sink;
+
+    /* Constructor. */
+    VirtualScreen(SerialBuffer &buffer, Sink out);
+
+    /* Functions. */
+    void reset(const char *prompt);
+    void setHeight(size_t height);
+    void setHighlighter(Highlighter *highlighter);
+    size_t getRow();
+    size_t getColumn();
+    size_t columnOf(size_t pos);
+    void moveTo(size_t row, size_t column);
+    void moveToOffset(size_t pos);
+    void text(const char *data, size_t length);
+    void newLine();
+    void clearToEnd();
+    void clearBelow();
+    void clear();
+    void redraw();
+    void openLine(size_t row);
+    void closeLine(size_t row);
+    void paintLine(size_t line, size_t from, bool clear = true);
+    void paintFrom(size_t line);
+    void paintRange(size_t from, size_t to);
+
+private:
+    size_t firstVisible();
+    size_t lastVisible();
+    size_t windowEnd();
+    void moveToRow(size_t row);
+    void reveal(size_t row);
+    void repaint(size_t first);
+    void command(const char *format, unsigned value);
+    size_t advance(size_t column, char c);
+    void paintSegment(size_t from, size_t to);
+
+private:
+    SerialBuffer &buffer;
+    Sink out;
+
+    /* Printed in front of line 0, origin is its width. */
+    const char *prompt;
+    size_t origin;
+
+    /* Cursor, relative to the first row of the buffer. */
+    size_t row;
+    size_t column;
+
+    /* Rows the buffer currently takes on screen, the ones from rows down are not painted. */
+    size_t rows;
+
+    /* Terminal rows, and the one the cursor is on. */
+    size_t height;
+    size_t screenRow;
+
+    /* Colours the text when set. */
+    Highlighter *highlighter;
+};
+
+#endif // _VIRTUALSCREEN_H
@@ -0,0 +1,794 @@
+/**
+ ******************************************************************************
+ * @file    Host.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Host harness that runs SerialInterface without a board.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mbed.h"
+#include "mbed_critical.h"
+#include "us_ticker_api.h"
+#include "Flasher.h"
+#include "jerryscript.h"
+#include "jerryscript-mbed-event-loop/EventLoop.h"
+#include "EditorThread.h"
+
+#include "Host.h"
+
+/* Harness state -------------------------------------------------------------*/
+
+/* Idle polls, 1 ms apart, without new output that count as settled. */
+#define HOST_SETTLE_POLLS   2
+
+static std::atomic<uint32_t> clockNow(1000000);
+
+static std::recursive_mutex critical;
+static thread_local bool inIsr = false;
+
+/* Serial port. */
+extern RawSerial pc;
+static std::mutex serialMutex;
+static std::deque<char> rxBytes;
+static std::string txBytes;
+static std::chrono::steady_clock::time_point txTime;
+static Callback<void()> rxHandler;
+
+/* Timeouts waiting for the clock. */
+static std::recursive_mutex timeoutMutex;
+static std::set<Timeout *> timeouts;
+
+/* Event loop; never destroyed, the loop thread waits on them until exit. */
+static std::mutex &loopMutex = *new std::mutex;
+static std::condition_variable &loopReady = *new std::condition_variable;
+static std::deque<Callback<void()> > loopQueue;
+static bool loopThreaded = false;
+static bool loopBusy = false;
+
+/* A script waiting for the clock. */
+static std::atomic<bool> loopSleeping(false);
+static std::atomic<uint32_t> sleepUntil(0);
+
+/* JavaScript values; 0 is undefined. Results of scripts are plain values,
+ * printed as their text, the other kinds are made by tests of the printer. */
+enum HostKind { PLAIN, STRING, FUNCTION, ARRAY, OBJECT };
+
+struct HostValue {
+    HostValue(const std::string &text, bool error, HostKind kind = PLAIN) : text(text), error(error), kind(kind) {
+    }
+
+    std::string text;
+    bool error;
+    HostKind kind;
+
+    /* Elements of an array, property values of an object. */
+    std::vector<jerry_value_t> items;
+    std::vector<std::string> keys;
+};
+
+static std::mutex valueMutex;
+static std::deque<HostValue> values(1, HostValue("undefined", false));
+static size_t keyListings = 0;
+
+static bool defaultScript(const std::string &code, std::string &result);
+static host::Script script = defaultScript;
+
+/* Flash. */
+static std::vector<uint32_t> sectors(128, 2048);
+static uint8_t *flash;
+static uint32_t imageSize;
+static long flashBudget = -1;
+static size_t erases;
+static size_t programs;
+
+/* Harness -------------------------------------------------------------------*/
+
+static void runLoop();
+
+/** defaultScript
+ * @brief	Runs every program fine, with an undefined result.
+ */
+static bool defaultScript(const std::string &code, std::string &result) {
+    (void)code;
+    result = "undefined";
+    return true;
+}
+
+/** interrupt
+ * @brief	Runs a handler the way an interrupt would, then the event loop.
+ */
+static void interrupt(const Callback<void()> &handler) {
+    {
+        // critical sections on other threads keep it out, as masking interrupts would
+        std::lock_guard<std::recursive_mutex> guard(critical);
+
+        inIsr = true;
+        handler();
+        inIsr = false;
+    }
+
+    if (!loopThreaded) {
+        runLoop();
+    }
+}
+
+/** runLoop
+ * @brief	Runs the queued native callbacks, in order.
+ */
+static void runLoop() {
+    while (true) {
+        Callback<void()> work;
+        {
+            std::lock_guard<std::mutex> guard(loopMutex);
+            if (loopQueue.empty()) return;
+
+            work = loopQueue.front();
+            loopQueue.pop_front();
+        }
+        work();
+    }
+}
+
+/** loopThread
+ * @brief	Event loop thread body.
+ */
+static void loopThread() {
+    while (true) {
+        Callback<void()> work;
+        {
+            std::unique_lock<std::mutex> guard(loopMutex);
+            loopReady.wait(guard, [] { return !loopQueue.empty(); });
+
+            work = loopQueue.front();
+            loopQueue.pop_front();
+            loopBusy = true;
+        }
+        work();
+
+        std::lock_guard<std::mutex> guard(loopMutex);
+        loopBusy = false;
+    }
+}
+
+void host::receive(const char *data, size_t length) {
+    {
+        std::lock_guard<std::mutex> guard(serialMutex);
+        rxBytes.insert(rxBytes.end(), data, data + length);
+    }
+
+    if (rxHandler) {
+        interrupt(rxHandler);
+    }
+}
+
+void host::type(const char *data, size_t length, uint32_t gap) {
+    for (size_t ix = 0; ix < length; ix++) {
+        advance(gap);
+        receive(data + ix, 1);
+    }
+}
+
+void host::advance(uint32_t us) {
+    setTime(clockNow + us);
+}
+
+void host::setTime(uint32_t time) {
+    clockNow = time;
+
+    while (true) {
+        Timeout *due = NULL;
+        {
+            std::lock_guard<std::recursive_mutex> guard(timeoutMutex);
+            for (std::set<Timeout *>::iterator it = timeouts.begin(); it != timeouts.end(); ++it) {
+                if ((*it)->due(time)) {
+                    due = *it;
+                    break;
+                }
+            }
+        }
+        if (!due) break;
+
+        interrupt(Callback<void()>(due, &Timeout::fire));
+    }
+
+    if (!loopThreaded) {
+        runLoop();
+    }
+}
+
+uint32_t host::now() {
+    return clockNow;
+}
+
+std::string host::output() {
+    std::lock_guard<std::mutex> guard(serialMutex);
+
+    std::string sent;
+    sent.swap(txBytes);
+    return sent;
+}
+
+std::chrono::steady_clock::time_point host::lastOutputTime() {
+    std::lock_guard<std::mutex> guard(serialMutex);
+    return txTime;
+}
+
+void host::settle() {
+    bool threaded = loopThreaded;
+#ifdef SERIAL_INTERFACE_EDITOR_THREAD
+    threaded = true;
+#endif
+    if (!threaded) return;
+
+    size_t last = (size_t)-1;
+    int quiet = 0;
+
+    while (quiet < HOST_SETTLE_POLLS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // callbacks queued by the editor thread, the main thread is the event loop
+        if (!loopThreaded) {
+            runLoop();
+        }
+
+        size_t sent;
+        {
+            std::lock_guard<std::mutex> guard(serialMutex);
+            sent = txBytes.size();
+        }
+        bool busy;
+        {
+            std::lock_guard<std::mutex> guard(loopMutex);
+            busy = loopBusy || !loopQueue.empty();
+        }
+        if (loopSleeping && (int32_t)(clockNow - sleepUntil) < 0) {
+            // nothing happens until the clock moves on
+            busy = false;
+        }
+        busy = busy || !EditorThread::idle();
+
+        quiet = (sent == last && !busy) ? quiet + 1 : 0;
+        last = sent;
+    }
+}
+
+void host::setThreadedEventLoop(bool threaded) {
+    if (threaded && !loopThreaded) {
+        std::thread(loopThread).detach();
+    }
+    loopThreaded = threaded;
+}
+
+void host::setScript(Script run) {
+    script = run ? run : defaultScript;
+}
+
+void host::console(const char *data, size_t length) {
+    FileHandle *console = mbed::mbed_override_console(1);
+
+    if (console) {
+        console->write(data, length);
+        return;
+    }
+
+    for (size_t ix = 0; ix < length; ix++) {
+        pc.putc(data[ix]);
+    }
+}
+
+void host::sleep(uint32_t us) {
+    sleepUntil = clockNow + us;
+    loopSleeping = true;
+
+    while ((int32_t)(clockNow - sleepUntil) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    loopSleeping = false;
+}
+
+void host::setFlashSectors(const uint32_t *sizes, size_t count) {
+    sectors.assign(sizes, sizes + count);
+}
+
+void host::setImageSize(uint32_t size) {
+    imageSize = size;
+}
+
+void host::setFlashBudget(long count) {
+    flashBudget = count;
+}
+
+uint32_t host::makeString(const std::string &text) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue(text, false, STRING));
+    return values.size() - 1;
+}
+
+uint32_t host::makeNumber(double number) {
+    char text[32];
+    snprintf(text, sizeof(text), "%g", number);
+
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue(text, false));
+    return values.size() - 1;
+}
+
+uint32_t host::makeFunction() {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue("function () {}", false, FUNCTION));
+    return values.size() - 1;
+}
+
+uint32_t host::makeArray() {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue("", false, ARRAY));
+    return values.size() - 1;
+}
+
+uint32_t host::makeObject() {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue("[object Object]", false, OBJECT));
+    return values.size() - 1;
+}
+
+void host::push(uint32_t array, uint32_t item) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    values[array].items.push_back(item);
+}
+
+void host::setProperty(uint32_t object, const std::string &key, uint32_t item) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values[object].keys.push_back(key);
+    values[object].items.push_back(item);
+}
+
+size_t host::objectKeyListings() {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    return keyListings;
+}
+
+size_t host::flashErases() {
+    return erases;
+}
+
+size_t host::flashPrograms() {
+    return programs;
+}
+
+/** spend
+ * @brief	Takes an erase or program from the budget.
+ * @return  false if the power is gone
+ */
+static bool spend() {
+    if (flashBudget == 0) return false;
+    if (flashBudget > 0) flashBudget--;
+    return true;
+}
+
+/* mbed ----------------------------------------------------------------------*/
+
+RawSerial pc(USBTX, USBRX);
+
+RawSerial::RawSerial(int tx, int rx, int baud) {
+    (void)tx;
+    (void)rx;
+    (void)baud;
+}
+
+int RawSerial::putc(int c) {
+    std::lock_guard<std::mutex> guard(serialMutex);
+    txBytes += (char)c;
+    txTime = std::chrono::steady_clock::now();
+    return c;
+}
+
+int RawSerial::getc() {
+    std::lock_guard<std::mutex> guard(serialMutex);
+    if (rxBytes.empty()) return -1;
+
+    char c = rxBytes.front();
+    rxBytes.pop_front();
+    return (unsigned char)c;
+}
+
+bool RawSerial::readable() {
+    std::lock_guard<std::mutex> guard(serialMutex);
+    return !rxBytes.empty();
+}
+
+void RawSerial::attach(Callback<void()> func) {
+    rxHandler = func;
+}
+
+int RawSerial::printf(const char *format, ...) {
+    char message[256];
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (length >= (int)sizeof(message)) length = sizeof(message) - 1;
+    for (int ix = 0; ix < length; ix++) {
+        putc(message[ix]);
+    }
+    return length;
+}
+
+Timeout::Timeout() : deadline(0), armed(false) {
+}
+
+Timeout::~Timeout() {
+    detach();
+}
+
+void Timeout::attach_us(Callback<void()> func, uint32_t us) {
+    std::lock_guard<std::recursive_mutex> guard(timeoutMutex);
+
+    this->func = func;
+    deadline = clockNow + us;
+    armed = true;
+    timeouts.insert(this);
+}
+
+void Timeout::detach() {
+    std::lock_guard<std::recursive_mutex> guard(timeoutMutex);
+
+    armed = false;
+    timeouts.erase(this);
+}
+
+bool Timeout::due(uint32_t now) {
+    return armed && (int32_t)(now - deadline) >= 0;
+}
+
+void Timeout::fire() {
+    Callback<void()> handler = func;
+    detach();
+    handler();
+}
+
+int FlashIAP::init() {
+    if (!flash) {
+        // the flash is memory mapped, its addresses must fit in 32 bits
+        flash = (uint8_t *)mmap(NULL, get_flash_size(), PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+        if (flash == MAP_FAILED) abort();
+
+        memset(flash, 0xff, get_flash_size());
+    }
+    return 0;
+}
+
+int FlashIAP::deinit() {
+    return 0;
+}
+
+int FlashIAP::read(void *buffer, uint32_t addr, uint32_t size) {
+    memcpy(buffer, (const void *)(uintptr_t)addr, size);
+    return 0;
+}
+
+int FlashIAP::program(const void *buffer, uint32_t addr, uint32_t size) {
+    if (addr % get_page_size() || size % get_page_size() || !spend()) return -1;
+
+    // flash bits only go from 1 to 0 without an erase
+    uint8_t *to = (uint8_t *)(uintptr_t)addr;
+    const uint8_t *from = (const uint8_t *)buffer;
+    for (uint32_t ix = 0; ix < size; ix++) {
+        if (to[ix] != 0xff) return -1;
+        to[ix] = from[ix];
+    }
+
+    programs++;
+    return 0;
+}
+
+int FlashIAP::erase(uint32_t addr, uint32_t size) {
+    // whole sectors; the RAM flash is only page aligned, so walk them
+    uint32_t start = get_flash_start();
+    while (start < addr && get_sector_size(start)) {
+        start += get_sector_size(start);
+    }
+    uint32_t end = start;
+    while (end < addr + size && get_sector_size(end)) {
+        end += get_sector_size(end);
+    }
+    if (start != addr || end != addr + size || !spend()) return -1;
+
+    memset((void *)(uintptr_t)addr, 0xff, size);
+    erases++;
+    return 0;
+}
+
+uint32_t FlashIAP::get_page_size() const {
+    return 8;
+}
+
+uint32_t FlashIAP::get_sector_size(uint32_t addr) const {
+    uint32_t start = get_flash_start();
+
+    for (size_t ix = 0; ix < sectors.size(); ix++) {
+        if (addr < start + sectors[ix]) return sectors[ix];
+        start += sectors[ix];
+    }
+    return 0;
+}
+
+uint32_t FlashIAP::get_flash_start() const {
+    return (uint32_t)(uintptr_t)flash;
+}
+
+uint32_t FlashIAP::get_flash_size() const {
+    uint32_t size = 0;
+
+    for (size_t ix = 0; ix < sectors.size(); ix++) {
+        size += sectors[ix];
+    }
+    return size;
+}
+
+uint32_t FlashIAP::app_rom_end() {
+    return (uint32_t)(uintptr_t)flash + imageSize;
+}
+
+void NVIC_SystemReset() {
+    // the board would start over, so does the harness
+    fflush(stdout);
+    exit(0);
+}
+
+// mbed's default, the serial port
+__attribute__((weak)) FileHandle *mbed::mbed_override_console(int fd) {
+    (void)fd;
+    return NULL;
+}
+
+void core_util_critical_section_enter(void) {
+    critical.lock();
+}
+
+void core_util_critical_section_exit(void) {
+    critical.unlock();
+}
+
+bool core_util_is_isr_active(void) {
+    return inIsr;
+}
+
+uint32_t us_ticker_read(void) {
+    return clockNow;
+}
+
+void Flasher::write_to_flash(char *data) {
+    (void)data;
+}
+
+js::EventLoop &js::EventLoop::getInstance() {
+    static EventLoop loop;
+    return loop;
+}
+
+void js::EventLoop::nativeCallback(mbed::Callback<void()> cb) {
+    std::lock_guard<std::mutex> guard(loopMutex);
+
+    loopQueue.push_back(cb);
+    loopReady.notify_one();
+}
+
+/* JerryScript ---------------------------------------------------------------*/
+
+/** value
+ * @brief	Adds a value.
+ */
+static jerry_value_t value(const std::string &text, bool error) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    values.push_back(HostValue(text, error));
+    return values.size() - 1;
+}
+
+/** kind
+ * @brief	Gets the kind of a value.
+ */
+static HostKind kind(jerry_value_t handle) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    return handle < values.size() ? values[handle].kind : PLAIN;
+}
+
+/** offset
+ * @brief	Gets where a character starts in CESU-8 text, counting every
+ *          byte but continuation bytes as a character.
+ */
+static size_t offset(const std::string &text, jerry_length_t index) {
+    size_t pos = 0;
+
+    for (; pos < text.size(); pos++) {
+        if (((unsigned char)text[pos] & 0xc0) == 0x80) continue;
+        if (index-- == 0) break;
+    }
+    return pos;
+}
+
+/** text
+ * @brief	Gets the text of a value.
+ */
+static std::string text(jerry_value_t handle) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    return handle < values.size() ? values[handle].text : "";
+}
+
+jerry_value_t jerry_parse(const jerry_char_t *source, size_t length, bool strict) {
+    (void)strict;
+    return value(std::string((const char *)source, length), false);
+}
+
+jerry_value_t jerry_run(jerry_value_t func) {
+    std::string result;
+    bool ok = script(text(func), result);
+
+    return value(result, !ok);
+}
+
+jerry_value_t jerry_exec_snapshot(const uint32_t *snapshot, size_t size, bool copy_bytecode) {
+    (void)snapshot;
+    (void)size;
+    (void)copy_bytecode;
+    return 0;
+}
+
+bool jerry_value_has_error_flag(jerry_value_t handle) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    return handle < values.size() && values[handle].error;
+}
+
+bool jerry_value_is_string(jerry_value_t handle) {
+    return kind(handle) == STRING;
+}
+
+bool jerry_value_is_function(jerry_value_t handle) {
+    return kind(handle) == FUNCTION;
+}
+
+bool jerry_value_is_array(jerry_value_t handle) {
+    return kind(handle) == ARRAY;
+}
+
+bool jerry_value_is_object(jerry_value_t handle) {
+    // as in JavaScript, functions and arrays are objects too
+    return kind(handle) >= FUNCTION;
+}
+
+jerry_value_t jerry_value_to_string(jerry_value_t handle) {
+    return value(text(handle), false);
+}
+
+jerry_value_t jerry_acquire_value(jerry_value_t handle) {
+    return handle;
+}
+
+void jerry_release_value(jerry_value_t handle) {
+    (void)handle;
+}
+
+jerry_length_t jerry_get_string_length(jerry_value_t handle) {
+    std::string str = text(handle);
+    jerry_length_t length = 0;
+
+    for (size_t pos = 0; pos < str.size(); pos++) {
+        if (((unsigned char)str[pos] & 0xc0) != 0x80) length++;
+    }
+    return length;
+}
+
+jerry_size_t jerry_substring_to_char_buffer(jerry_value_t handle, jerry_length_t start, jerry_length_t end,
+                                            jerry_char_t *buffer, jerry_size_t size) {
+    std::string str = text(handle);
+    size_t from = offset(str, start);
+    std::string part = str.substr(from, offset(str, end) - from);
+    if (part.size() > size) return 0;
+
+    memcpy(buffer, part.data(), part.size());
+    return part.size();
+}
+
+uint32_t jerry_get_array_length(jerry_value_t handle) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+    return handle < values.size() && values[handle].kind == ARRAY ? values[handle].items.size() : 0;
+}
+
+jerry_value_t jerry_get_property_by_index(jerry_value_t object, uint32_t index) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    if (object >= values.size() || values[object].kind != ARRAY) return 0;
+    return index < values[object].items.size() ? values[object].items[index] : 0;
+}
+
+jerry_value_t jerry_get_property(jerry_value_t object, jerry_value_t name) {
+    std::string key = text(name);
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    if (object >= values.size()) return 0;
+
+    const HostValue &found = values[object];
+    for (size_t ix = 0; ix < found.keys.size(); ix++) {
+        if (found.keys[ix] == key) return found.items[ix];
+    }
+    return 0;
+}
+
+jerry_value_t jerry_get_object_keys(jerry_value_t object) {
+    std::vector<std::string> keys;
+    {
+        std::lock_guard<std::mutex> guard(valueMutex);
+
+        keyListings++;
+        if (object < values.size()) keys = values[object].keys;
+    }
+
+    jerry_value_t list = host::makeArray();
+    for (size_t ix = 0; ix < keys.size(); ix++) {
+        host::push(list, host::makeString(keys[ix]));
+    }
+    return list;
+}
+
+bool jerry_get_memory_stats(jerry_heap_stats_t *stats) {
+    std::lock_guard<std::mutex> guard(valueMutex);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->allocated_bytes = values.size() * 16;
+    stats->peak_allocated_bytes = stats->allocated_bytes;
+    return true;
+}
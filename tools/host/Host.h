@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * @file    Host.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Host harness that runs SerialInterface without a board.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _HOST_H
+#define _HOST_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <chrono>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * The host harness stands in for the board: bytes from the terminal are fed
+ * to the RX interrupt, bytes sent by the board are collected, the us_ticker
+ * clock only moves when told to and programs go to a script of the test.
+ */
+namespace host {
+
+/* Runs a program for jerry_run(), returns false if it throws. */
+typedef bool (*Script)(const std::string &code, std::string &result);
+
+/* Bytes arriving at once, handled by one RX interrupt. */
+void receive(const char *data, size_t length);
+
+/* Bytes arriving one per interrupt, gap us apart. */
+void type(const char *data, size_t length, uint32_t gap);
+
+/* Moves the clock on, runs the Timeouts that fall due. */
+void advance(uint32_t us);
+void setTime(uint32_t time);
+uint32_t now();
+
+/* Takes the bytes sent since the last call. */
+std::string output();
+
+/* When the last byte was sent, on the host's clock. */
+std::chrono::steady_clock::time_point lastOutputTime();
+
+/* Waits until the editor and JavaScript threads have gone quiet. */
+void settle();
+
+/* Event loop on a thread of its own instead of after each interrupt. */
+void setThreadedEventLoop(bool threaded);
+
+void setScript(Script script);
+
+/* For scripts: writes to stdout of the board, which is the console set with
+ * mbed_override_console() or else the serial port. */
+void console(const char *data, size_t length);
+
+/* For scripts: waits until the clock has moved on by us, settle() doesn't
+ * wait for it. Needs the threaded event loop. */
+void sleep(uint32_t us);
+
+/* For tests of the result printer: values of each kind, arrays and objects
+ * start out empty. Numbers are printed as their text, like script results. */
+uint32_t makeString(const std::string &text);
+uint32_t makeNumber(double number);
+uint32_t makeFunction();
+uint32_t makeArray();
+uint32_t makeObject();
+void push(uint32_t array, uint32_t item);
+void setProperty(uint32_t object, const std::string &key, uint32_t item);
+
+/* Calls of jerry_get_object_keys() so far. */
+size_t objectKeyListings();
+
+/* Sector sizes of the RAM flash, before its first use. */
+void setFlashSectors(const uint32_t *sizes, size_t count);
+
+/* Bytes of firmware image at the start of the flash, none by default. */
+void setImageSize(uint32_t size);
+
+/* Lets count more erases and programs through, then fails them all as if the
+ * board had lost power; -1, the default, lets all through. */
+void setFlashBudget(long count);
+
+/* Erases and programs done on the RAM flash so far. */
+size_t flashErases();
+size_t flashPrograms();
+
+} // namespace host
+
+#endif // _HOST_H
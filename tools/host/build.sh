@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# build.sh
+#
+# Builds a host program against SerialInterface, with the mbed and JerryScript
+# stand-ins of tools/host. Extra arguments go to the compiler, e.g. the same
+# SERIAL_INTERFACE_* macros as the firmware.
+#
+# Usage: tools/host/build.sh <output> <program.cpp> [compiler flags]
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "usage: build.sh <output> <program.cpp> [compiler flags]" >&2
+    exit 2
+fi
+
+host=$(cd "$(dirname "$0")" && pwd)
+lib="$host/../../SerialInterface_JS"
+output=$1
+program=$2
+shift 2
+
+includes="-I$host/stubs -I$host"
+for dir in "$lib"/*/; do
+    includes="$includes -I$dir"
+done
+
+# SerialInterface-js.cpp is the JavaScript binding, it needs the real JerryScript
+sources=$(ls "$lib"/*/*.cpp)
+
+${CXX:-g++} -std=gnu++11 -O2 -g -Wall -pthread -DJSMBED_USE_RAW_SERIAL "$@" \
+    $includes "$program" "$host/Host.cpp" $sources -o "$output"
@@ -0,0 +1,201 @@
+/**
+ ******************************************************************************
+ * @file    highlight.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Differential test of the incremental Highlighter on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Highlighter.h"
+#include "SerialBuffer.h"
+
+/* Highlight -----------------------------------------------------------------*/
+
+/**
+ * Makes random edits to a program made of JavaScript fragments, the ones that
+ * open and close strings and comments most of all, and checks after each one
+ * that the incrementally updated tokens are the ones rebuild() finds from
+ * scratch, and that the span update() reports holds every character outside
+ * the edit whose colour changed.
+ *
+ * Usage: highlight [edits] [seed]
+ */
+
+/* Edits made by default. */
+#define HIGHLIGHT_EDITS     200000
+
+/* Programs are started again from empty when they grow past this. */
+#define HIGHLIGHT_MAX_SIZE  400
+
+static const char *fragments[] = {
+    "/*", "*/", "//", "\"", "'", "`", "\\", "\n", " ", "*", "/",
+    "var", "if", "x", "a1", "0", "3.5", "1e3", "(", ")", ";", "=", "$_"
+};
+
+/** tokens
+ * @brief	The tokens of a highlighter as (start, type) pairs.
+ */
+static std::vector<std::pair<size_t, int> > tokens(Highlighter &highlighter, SerialBuffer &buffer) {
+    std::vector<std::pair<size_t, int> > list;
+
+    for (size_t pos = 0; pos < buffer.size(); ) {
+        size_t end;
+        Highlighter::Type type = highlighter.typeAt(buffer, pos, end);
+
+        list.push_back(std::make_pair(pos, (int)type));
+        pos = end;
+    }
+    return list;
+}
+
+/** colors
+ * @brief	The colour of every character.
+ */
+static std::vector<const char *> colors(Highlighter &highlighter, SerialBuffer &buffer) {
+    std::vector<const char *> list;
+
+    for (size_t pos = 0; pos < buffer.size(); ) {
+        size_t end;
+        const char *color = Highlighter::color(highlighter.typeAt(buffer, pos, end));
+
+        while (pos < end) {
+            list.push_back(color);
+            pos++;
+        }
+    }
+    return list;
+}
+
+/** quote
+ * @brief	Text with the line breaks shown, for the report.
+ */
+static std::string quote(const std::string &text) {
+    std::string quoted;
+
+    for (size_t ix = 0; ix < text.size(); ix++) {
+        if (text[ix] == '\n') quoted += "\\n";
+        else quoted += text[ix];
+    }
+    return quoted;
+}
+
+int main(int argc, char **argv) {
+    long edits = argc > 1 ? atol(argv[1]) : HIGHLIGHT_EDITS;
+    unsigned seed = argc > 2 ? (unsigned)atol(argv[2]) : 1;
+    std::mt19937 random(seed);
+
+    SerialBuffer buffer;
+    Highlighter incremental;
+    incremental.rebuild(buffer);
+
+    for (long edit = 0; edit < edits; edit++) {
+        if (buffer.size() > HIGHLIGHT_MAX_SIZE) {
+            buffer.clear();
+            incremental.rebuild(buffer);
+        }
+
+        std::string before = buffer.get_string();
+        std::vector<const char *> oldColors = colors(incremental, buffer);
+
+        // a keystroke, a paste, a backspace or a selection typed over
+        size_t pos = random() % (buffer.size() + 1);
+        size_t removed = 0;
+        std::string inserted;
+
+        switch (random() % 4) {
+            case 0:
+                inserted = fragments[random() % (sizeof(fragments) / sizeof(fragments[0]))];
+                break;
+            case 1:
+                for (int count = random() % 6 + 1; count > 0; count--) {
+                    inserted += fragments[random() % (sizeof(fragments) / sizeof(fragments[0]))];
+                }
+                break;
+            case 2:
+                removed = pos > 0 ? 1 : 0;
+                break;
+            default:
+                removed = random() % (pos + 1) % 4;
+                inserted = fragments[random() % (sizeof(fragments) / sizeof(fragments[0]))];
+                break;
+        }
+
+        buffer.setPosition(pos);
+        for (size_t ix = 0; ix < removed; ix++) {
+            buffer.remove();
+        }
+        pos -= removed;
+        buffer.add(inserted);
+
+        size_t from, to;
+        incremental.update(buffer, pos, inserted.size(), removed, from, to);
+
+        Highlighter fresh;
+        fresh.rebuild(buffer);
+
+        const char *error = NULL;
+        if (tokens(incremental, buffer) != tokens(fresh, buffer)) {
+            error = "tokens differ from a rebuild";
+        }
+        else {
+            std::vector<const char *> newColors = colors(incremental, buffer);
+
+            for (size_t ix = 0; ix < newColors.size() && !error; ix++) {
+                if (ix >= pos && ix < pos + inserted.size()) continue;
+
+                size_t oldIx = ix < pos ? ix : ix - inserted.size() + removed;
+                if (newColors[ix] != oldColors[oldIx] && (ix < from || ix >= to)) {
+                    error = "colour changed outside the repainted span";
+                }
+            }
+        }
+
+        if (error) {
+            printf("edit %ld: %s\n  before   \"%s\"\n  at %lu removed %lu inserted \"%s\"\n  after    \"%s\"\n",
+                   edit, error, quote(before).c_str(), (unsigned long)pos, (unsigned long)removed,
+                   quote(inserted).c_str(), quote(buffer.get_string()).c_str());
+            return 1;
+        }
+    }
+
+    printf("%ld edits, tokens always as rebuilt\n", edits);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * @file    journal.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Power loss test of the ScriptFlash header journal on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "ScriptFlash.h"
+#include "Host.h"
+
+/* Journal -------------------------------------------------------------------*/
+
+/**
+ * Flashes versions of a program one after the other, enough for the header
+ * journal to move between its sectors several times. Each store is first
+ * cut short by a power loss after every number of flash operations it takes,
+ * and after each a freshly booted ScriptFlash must find the old version, or
+ * no program once the pending header is written; never a damaged one.
+ *
+ * Usage: journal [versions]
+ */
+
+/* Versions flashed by default, about five times round the journal. */
+#define JOURNAL_VERSIONS    250
+
+/** version
+ * @brief	A program which differs in length and content from the one before.
+ * @param	Version number
+ */
+static std::string version(int number) {
+    char line[64];
+    std::string code;
+
+    for (int ix = 0; ix <= number % 7; ix++) {
+        snprintf(line, sizeof(line), "var version%d = %d;\n", ix, number);
+        code += line;
+    }
+    return code;
+}
+
+/** boot
+ * @brief	Loads the program the way booting does, into text.
+ * @return  false if there is none
+ */
+static bool boot(std::string &text, const char *&error) {
+    ScriptFlash flash;
+    const char *code;
+    size_t length;
+
+    if (!flash.load(code, length, false)) {
+        error = flash.getError();
+        return false;
+    }
+
+    text.assign(code, length);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int versions = argc > 1 ? atoi(argv[1]) : JOURNAL_VERSIONS;
+    std::string previous;
+    long cuts = 0;
+
+    for (int number = 0; number < versions; number++) {
+        std::string next = version(number);
+
+        for (long budget = 0; ; budget++) {
+            ScriptFlash flash;
+            ScriptFlashStats stats;
+
+            size_t programs = host::flashPrograms();
+            host::setFlashBudget(budget);
+            bool stored = flash.store(next.data(), next.size(), stats);
+            host::setFlashBudget(-1);
+
+            std::string loaded;
+            const char *error = NULL;
+            bool found = boot(loaded, error);
+
+            if (stored) {
+                if (!found || loaded != next) {
+                    printf("version %d: not loaded after the store (%s)\n", number, error ? error : "other program");
+                    return 1;
+                }
+                break;
+            }
+
+            cuts++;
+            if (found ? loaded != previous : strcmp(error, "no program") != 0) {
+                printf("version %d, power lost after %ld operations: %s\n", number, budget,
+                       found ? "other program loaded" : error);
+                return 1;
+            }
+
+            // the pending header is the first thing programmed, the old version stands until then
+            if (!found && number > 0 && host::flashPrograms() == programs) {
+                printf("version %d, power lost after %ld operations: lost before the update was pending\n",
+                       number, budget);
+                return 1;
+            }
+        }
+
+        previous = next;
+    }
+
+    printf("%d versions, %ld power losses, %lu erases\n", versions, cuts, (unsigned long)host::flashErases());
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ * @file    paste-bench.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Paste throughput benchmark on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+
+#include "SerialInterface.h"
+#include "Host.h"
+
+/* Benchmark -----------------------------------------------------------------*/
+
+/* Line speed the wire times are worked out for. */
+#ifndef PASTE_BENCH_BAUD
+#define PASTE_BENCH_BAUD    115200
+#endif
+
+/* us a byte takes on the wire, 8N1. */
+static const double byteTime = 10e6 / PASTE_BENCH_BAUD;
+
+/** program
+ * @brief	A 40 line program, about 1.7 KB.
+ */
+static std::string program() {
+    std::string code;
+    char line[80];
+
+    for (int ix = 0; ix < 40; ix++) {
+        snprintf(line, sizeof(line), "var value%02d = sensor.read(%d) * %d.5 + offset; // sample %d\r",
+                 ix, ix % 4, ix, ix);
+        code += line;
+    }
+    return code;
+}
+
+/** paste
+ * @brief	Pastes text at line speed and reports what it cost.
+ * @param	Name of the case
+ * @param	Text as the terminal sends it
+ */
+static void paste(const char *name, const std::string &text) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // the echo of each byte can start once it is in, and queues behind earlier echo
+    double txFree = 0;
+    size_t tx = 0;
+
+    for (size_t ix = 0; ix < text.size(); ix++) {
+        host::type(&text[ix], 1, (uint32_t)byteTime);
+
+        size_t sent = host::output().size();
+        double in = (ix + 1) * byteTime;
+
+        txFree = (txFree > in ? txFree : in) + sent * byteTime;
+        tx += sent;
+    }
+
+    // the paste ends on a gap in the input
+    host::advance(SERIAL_INTERFACE_PASTE_GAP_US + 1);
+
+    double quiet = text.size() * byteTime + SERIAL_INTERFACE_PASTE_GAP_US;
+    size_t sent = host::output().size();
+    if (sent) {
+        txFree = (txFree > quiet ? txFree : quiet) + sent * byteTime;
+        tx += sent;
+    }
+
+    double cpu = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    double done = txFree > text.size() * byteTime ? txFree : text.size() * byteTime;
+
+    printf("%-22s %6u %8u %8.2f %10.1f %10.0f %8.2f\n", name, unsigned(text.size()), unsigned(tx),
+           double(tx) / text.size(), done / 1000, text.size() / (done / 1e6), cpu / text.size());
+}
+
+/** clear
+ * @brief	Runs the buffer to get an empty one, output dropped.
+ */
+static void clear() {
+    host::advance(1000000);
+    host::receive("\x12", 1);
+    host::settle();
+    host::output();
+}
+
+/** typeLine
+ * @brief	Types a line at typing speed, leaves the cursor before its last two characters.
+ */
+static void typeLine() {
+    const char *line = "var samples = [];";
+
+    host::type(line, strlen(line), 200000);
+    host::type("\033[D\033[D", 6, 200000);
+    host::output();
+}
+
+int main() {
+    // lives on like the one the JavaScript side creates
+    new SerialInterface();
+    std::string code = program();
+
+    host::output();
+
+    printf("paste gap %u us, bracketed paste %s, %u baud\n", unsigned(SERIAL_INTERFACE_PASTE_GAP_US),
+           SERIAL_INTERFACE_BRACKETED_PASTE ? "on" : "off", unsigned(PASTE_BENCH_BAUD));
+    printf("%-22s %6s %8s %8s %10s %10s %8s\n", "case", "RX", "TX", "TX/RX", "wire ms", "bytes/s", "cpu us/B");
+
+    paste("end of buffer", code);
+    clear();
+
+    typeLine();
+    paste("mid-line", code);
+    clear();
+
+#if SERIAL_INTERFACE_BRACKETED_PASTE
+    paste("bracketed, end", "\033[200~" + code + "\033[201~");
+    clear();
+
+    typeLine();
+    paste("bracketed, mid-line", "\033[200~" + code + "\033[201~");
+    clear();
+#endif
+
+    return 0;
+}
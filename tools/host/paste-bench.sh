@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# paste-bench.sh
+#
+# Pastes a 40 line program into a host build of SerialInterface and reports the
+# bytes sent back, the time until the paste is on screen at line speed and the
+# host CPU time per byte. "before" is the same tree with paste detection
+# compiled out (SERIAL_INTERFACE_PASTE_GAP_US=0, no bracketed paste), i.e. the
+# per-character echo and redraw path.
+#
+# Usage: tools/host/paste-bench.sh [compiler flags]
+
+set -e
+
+host=$(cd "$(dirname "$0")" && pwd)
+build="$host/build"
+mkdir -p "$build"
+
+"$host/build.sh" "$build/paste-bench-before" "$host/paste-bench.cpp" \
+    -DSERIAL_INTERFACE_PASTE_GAP_US=0 -DSERIAL_INTERFACE_BRACKETED_PASTE=0 "$@"
+"$host/build.sh" "$build/paste-bench" "$host/paste-bench.cpp" "$@"
+
+echo "before:"
+"$build/paste-bench-before"
+echo
+echo "after:"
+"$build/paste-bench"
@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file    printer.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Test of the ResultPrinter limits on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+#include <string>
+
+#include "ResultPrinter.h"
+#include "Host.h"
+
+/* Printer -------------------------------------------------------------------*/
+
+/**
+ * Prints values built with the host's arrays and objects through the depth,
+ * element and byte limits and the cycle check, and compares the output with
+ * what the REPL should show. Objects past the depth limit must be printed
+ * without listing their keys, and a byte limit inside a multi-byte character
+ * must cut before it.
+ *
+ * Usage: printer
+ */
+
+/* Output of the current case. */
+static std::string printed;
+
+static void collect(const char *data, size_t length) {
+    printed.append(data, length);
+}
+
+/** array
+ * @brief	An array of the numbers 0 to count - 1.
+ * @param	Count
+ */
+static uint32_t array(int count) {
+    uint32_t value = host::makeArray();
+
+    for (int ix = 0; ix < count; ix++) {
+        host::push(value, host::makeNumber(ix));
+    }
+    return value;
+}
+
+/** object
+ * @brief	An object of the properties k0: 0 to k<count - 1>: count - 1.
+ * @param	Count
+ */
+static uint32_t object(int count) {
+    uint32_t value = host::makeObject();
+
+    for (int ix = 0; ix < count; ix++) {
+        host::setProperty(value, "k" + std::to_string(ix), host::makeNumber(ix));
+    }
+    return value;
+}
+
+/** check
+ * @brief	Prints a value with the given limits.
+ * @param	What is tested
+ * @return  false if the output is not the one expected
+ */
+static bool check(const char *what, ResultPrinter &printer, uint32_t value, size_t maxDepth, size_t maxElements,
+                  size_t maxBytes, const std::string &expected) {
+    printed.clear();
+    printer.setLimits(maxDepth, maxElements, maxBytes);
+    printer.print(value);
+
+    if (printed != expected) {
+        printf("%s: printed '%s', not '%s'\n", what, printed.c_str(), expected.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    ResultPrinter printer((ResultPrinter::Sink(collect)));
+    bool ok = true;
+
+    // {a: [1, [2, [3]]], b: {}, c: {d: {e: 1}}, f: "x", g: function}
+    uint32_t nested = host::makeObject();
+    uint32_t a = host::makeArray();
+    uint32_t a1 = host::makeArray();
+    uint32_t a2 = host::makeArray();
+    host::push(a2, host::makeNumber(3));
+    host::push(a1, host::makeNumber(2));
+    host::push(a1, a2);
+    host::push(a, host::makeNumber(1));
+    host::push(a, a1);
+    uint32_t c = host::makeObject();
+    uint32_t d = host::makeObject();
+    host::setProperty(d, "e", host::makeNumber(1));
+    host::setProperty(c, "d", d);
+    host::setProperty(nested, "a", a);
+    host::setProperty(nested, "b", host::makeObject());
+    host::setProperty(nested, "c", c);
+    host::setProperty(nested, "f", host::makeString("x"));
+    host::setProperty(nested, "g", host::makeFunction());
+
+    ok &= check("depth 8", printer, nested, 8, 32, 1024,
+                "{a: [1, [2, [3]]], b: {}, c: {d: {e: 1}}, f: \"x\", g: [Function]}");
+
+    size_t listings = host::objectKeyListings();
+    ok &= check("depth 2", printer, nested, 2, 32, 1024, "{a: [1, [...]], b: {}, c: {d: {...}}, f: \"x\", g: [Function]}");
+    // the outer object, b and c; not d, which is past the limit
+    if (host::objectKeyListings() - listings != 3) {
+        printf("depth 2: keys listed %lu times, not 3\n", (unsigned long)(host::objectKeyListings() - listings));
+        ok = false;
+    }
+    ok &= check("depth 0", printer, nested, 0, 32, 1024, "{...}");
+    ok &= check("empty array at the limit", printer, host::makeArray(), 0, 32, 1024, "[]");
+
+    ok &= check("elements of an array", printer, array(5), 3, 3, 1024, "[0, 1, 2, ...]");
+    ok &= check("elements of an object", printer, object(5), 3, 3, 1024, "{k0: 0, k1: 1, k2: 2, ...}");
+    ok &= check("elements, all", printer, array(3), 3, 3, 1024, "[0, 1, 2]");
+
+    ok &= check("bytes of a string", printer, host::makeString("abcdefghij"), 3, 32, 8, "\"abcdefg...");
+    ok &= check("bytes of an array", printer, array(20), 3, 32, 12, "[0, 1, 2, 3,...");
+    ok &= check("bytes, exactly", printer, host::makeString("abcdef"), 3, 32, 8, "\"abcdef\"");
+
+    // € is 3 bytes, the limit falls after the second of the second one
+    ok &= check("bytes of a CESU-8 string", printer, host::makeString("ab\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac"), 3, 32, 7,
+                "\"ab\xe2\x82\xac...");
+    ok &= check("chunks of a CESU-8 string", printer, host::makeString(std::string(40, 'x') + "\xc3\xa9"), 3, 32, 1024,
+                "\"" + std::string(40, 'x') + "\xc3\xa9\"");
+
+    uint32_t self = host::makeObject();
+    host::setProperty(self, "name", host::makeString("loop"));
+    host::setProperty(self, "self", self);
+    ok &= check("object cycle", printer, self, 8, 32, 1024, "{name: \"loop\", self: [Circular]}");
+
+    uint32_t ring = host::makeArray();
+    uint32_t inner = host::makeObject();
+    host::setProperty(inner, "up", ring);
+    host::push(ring, inner);
+    ok &= check("array cycle", printer, ring, 8, 32, 1024, "[{up: [Circular]}]");
+
+    // the same object twice, side by side, is not a cycle
+    uint32_t shared = object(1);
+    uint32_t twice = host::makeArray();
+    host::push(twice, shared);
+    host::push(twice, shared);
+    ok &= check("shared object", printer, twice, 8, 32, 1024, "[{k0: 0}, {k0: 0}]");
+
+    if (!ok) return 1;
+
+    printf("all cases printed as expected\n");
+    return 0;
+}
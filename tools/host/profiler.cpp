@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file    profiler.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Test of the Profiler ring on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+#include "Profiler.h"
+#include "Host.h"
+
+/* Profiler ------------------------------------------------------------------*/
+
+/**
+ * Profiles more runs than the ring holds, on a clock that wraps in the middle
+ * of one, and checks the times, code sizes and results of the runs kept,
+ * oldest first. With PROFILER_HEAP_STATS each run allocates a number of host
+ * values, whose bytes must show up as its heap delta; without it the heap
+ * fields must be marked invalid.
+ *
+ * Usage: profiler (built with -DPROFILER_RUNS=4, with or without -DPROFILER_HEAP_STATS)
+ */
+
+/* Runs profiled, more than the ring holds. */
+#define PROFILER_TEST_RUNS  6
+
+/* Bytes the host counts for each value. */
+#define PROFILER_VALUE_SIZE 16
+
+/** profile
+ * @brief	Profiles one run, whose numbers all follow from its index.
+ * @param	Profiler
+ * @param	Run index
+ */
+static void profile(Profiler &profiler, int run) {
+    profiler.begin(100 + run);
+
+    host::setTime(host::now() + 1000 * (run + 1));
+    profiler.parsed();
+
+    for (int ix = 0; ix < run; ix++) {
+        host::makeString("value");
+    }
+
+    host::setTime(host::now() + 10000 * (run + 1));
+    profiler.end(run % 3 != 2);
+}
+
+/** check
+ * @brief	Checks the record of a run.
+ * @param	Record
+ * @param	Run index
+ * @return  false if it doesn't match the run
+ */
+static bool check(const ProfileRecord &record, int run) {
+    const char *error = NULL;
+
+    if (record.codeSize != (uint32_t)(100 + run)) error = "code size";
+    else if (record.parseTime != (uint32_t)(1000 * (run + 1))) error = "parse time";
+    else if (record.runTime != (uint32_t)(10000 * (run + 1))) error = "run time";
+    else if (record.ok != (run % 3 != 2)) error = "result";
+#ifdef PROFILER_HEAP_STATS
+    else if (!record.heapValid) error = "heap not sampled";
+    else if (record.heapDelta != run * PROFILER_VALUE_SIZE) error = "heap delta";
+    else if (record.heapPeak < (uint32_t)(run * PROFILER_VALUE_SIZE)) error = "heap peak";
+#else
+    else if (record.heapValid) error = "heap sampled without PROFILER_HEAP_STATS";
+#endif
+
+    if (error) {
+        printf("run %d: wrong %s (parse %lu us, run %lu us, heap %+ld B, %lu B of code)\n", run, error,
+               (unsigned long)record.parseTime, (unsigned long)record.runTime, (long)record.heapDelta,
+               (unsigned long)record.codeSize);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    Profiler profiler;
+    ProfileRecord record;
+
+    // the clock wraps while the second run parses
+    host::setTime(0xffffffff - 12000);
+
+    for (int run = 0; run < PROFILER_TEST_RUNS; run++) {
+        profile(profiler, run);
+        if (!check(profiler.last(), run)) return 1;
+    }
+
+    if (profiler.size() != PROFILER_RUNS) {
+        printf("%lu runs kept, not %d\n", (unsigned long)profiler.size(), PROFILER_RUNS);
+        return 1;
+    }
+
+    // oldest first, the first runs overwritten
+    for (int ix = 0; ix < PROFILER_RUNS; ix++) {
+        if (!profiler.get(ix, record)) {
+            printf("run %d missing\n", ix);
+            return 1;
+        }
+        if (!check(record, PROFILER_TEST_RUNS - PROFILER_RUNS + ix)) return 1;
+    }
+    if (profiler.get(PROFILER_RUNS, record)) {
+        printf("a run past the end\n");
+        return 1;
+    }
+
+    profiler.clear();
+    if (profiler.size() != 0 || profiler.get(0, record)) {
+        printf("runs left after clear()\n");
+        return 1;
+    }
+
+    profile(profiler, 1);
+    if (profiler.size() != 1 || !profiler.get(0, record) || !check(record, 1)) {
+        printf("run after clear() not kept first\n");
+        return 1;
+    }
+
+    printf("%d runs, the last %d kept\n", PROFILER_TEST_RUNS, PROFILER_RUNS);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ * @file    replay.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Replays recorded serial input through a host build of SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SerialInterface.h"
+#include "Host.h"
+
+/* Replay --------------------------------------------------------------------*/
+
+/**
+ * Reads the received bytes of a trace from stdin, one "<us_ticker time> <byte>"
+ * per line in hex, and feeds each at its recorded time; bytes with the same
+ * time arrive in one interrupt. Timeouts (e.g. the end of a paste) fire at
+ * the same points as on the board. For every byte it writes "<index>
+ * <latency us> <bytes sent in response, hex>", where the response is what was
+ * sent until the next byte came in, and the latency is the host time until
+ * the last of it was sent. A first "boot 0 <hex>" line holds what was sent
+ * before the first byte.
+ *
+ * Usage: replay [--prompt] [--loop-thread] [--flash-sectors <count>x<size>,...]
+ *               [--image-size <bytes>]
+ *   --prompt         start from a prompt as left by Ctrl+T
+ *   --loop-thread    run JavaScript on a thread of its own, as on the board, so
+ *                    input is handled while a program runs
+ *   --flash-sectors  sector sizes of the flash, e.g. 4x16384,1x65536,7x131072
+ *                    for an STM32F4 with 1 MB
+ *   --image-size     bytes of firmware at the start of the flash, which the
+ *                    script regions must stay clear of
+ *
+ * trace-replay.js --host runs this and compares the result with the trace.
+ * Programs run by the host tests use host.print("text") to print a line to
+ * the console and host.sleep(ms) to wait for the clock (with --loop-thread);
+ * anything else in a program is ignored.
+ */
+
+struct Response {
+    double latency;
+    std::string sent;
+};
+
+struct Received {
+    uint32_t time;
+    char c;
+};
+
+static bool loopThread = false;
+
+/* What was sent before the first byte, and in response to each. */
+static std::string boot;
+static std::vector<Response> responses;
+
+/** runProgram
+ * @brief	Runs the host.print() and host.sleep() calls of a program.
+ */
+static bool runProgram(const std::string &code, std::string &result) {
+    size_t pos = 0;
+
+    while ((pos = code.find("host.", pos)) != std::string::npos) {
+        pos += 5;
+
+        if (code.compare(pos, 7, "print(\"") == 0) {
+            size_t end = code.find("\")", pos + 7);
+            if (end == std::string::npos) break;
+
+            // as the JerryScript port prints it
+            std::string line = code.substr(pos + 7, end - pos - 7) + "\r\n";
+            host::console(line.data(), line.size());
+            pos = end;
+        }
+        else if (code.compare(pos, 6, "sleep(") == 0 && loopThread) {
+            host::sleep(strtoul(code.c_str() + pos + 6, NULL, 10) * 1000);
+        }
+    }
+
+    result = "undefined";
+    return true;
+}
+
+/** printResponses
+ * @brief	Prints the responses, also when the program resets the board (Ctrl+F).
+ */
+static void printResponses() {
+    std::string &last = responses.empty() ? boot : responses.back().sent;
+    last += host::output();
+
+    printf("boot 0 ");
+    for (size_t ix = 0; ix < boot.size(); ix++) {
+        printf("%02x", (unsigned char)boot[ix]);
+    }
+    printf("\n");
+
+    for (size_t ix = 0; ix < responses.size(); ix++) {
+        printf("%u %.1f ", unsigned(ix), responses[ix].latency);
+        for (size_t jx = 0; jx < responses[ix].sent.size(); jx++) {
+            printf("%02x", (unsigned char)responses[ix].sent[jx]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    bool prompt = false;
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--prompt") == 0) prompt = true;
+        else if (strcmp(argv[ix], "--loop-thread") == 0) loopThread = true;
+        else if (strcmp(argv[ix], "--flash-sectors") == 0 && ix + 1 < argc) {
+            std::vector<uint32_t> sectors;
+            const char *spec = argv[++ix];
+            char *next;
+
+            while (*spec) {
+                unsigned long count = strtoul(spec, &next, 0);
+                if (*next != 'x') break;
+                unsigned long size = strtoul(next + 1, &next, 0);
+
+                sectors.insert(sectors.end(), count, (uint32_t)size);
+                spec = *next == ',' ? next + 1 : next;
+            }
+            host::setFlashSectors(sectors.data(), sectors.size());
+        }
+        else if (strcmp(argv[ix], "--image-size") == 0 && ix + 1 < argc) {
+            host::setImageSize((uint32_t)strtoul(argv[++ix], NULL, 0));
+        }
+    }
+
+    host::setScript(runProgram);
+    atexit(printResponses);
+    host::setThreadedEventLoop(loopThread);
+
+    // lives on like the one the JavaScript side creates, its threads never stop
+    SerialInterface *serial = new SerialInterface();
+    if (prompt) {
+        serial->printJustHappened();
+    }
+    host::settle();
+    boot = host::output();
+
+    std::vector<Received> received;
+    unsigned long time;
+    unsigned byte;
+
+    while (scanf("%lx %x", &time, &byte) == 2) {
+        Received rx = { (uint32_t)time, (char)byte };
+        received.push_back(rx);
+    }
+
+    for (size_t ix = 0; ix < received.size(); ) {
+        // what fell due before these bytes still answers the previous one
+        host::setTime(received[ix].time);
+        host::settle();
+        if (!responses.empty()) {
+            responses.back().sent += host::output();
+        }
+
+        std::string data;
+        for (size_t jx = ix; jx < received.size() && received[jx].time == received[ix].time; jx++) {
+            data += received[jx].c;
+        }
+
+        // the bytes that came along answer nothing by themselves
+        Response response = { 0, "" };
+        responses.insert(responses.end(), data.size(), response);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        host::receive(data.data(), data.size());
+
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        host::settle();
+
+        responses.back().sent = host::output();
+        if (!responses.back().sent.empty() && host::lastOutputTime() > end) {
+            end = host::lastOutputTime();
+        }
+
+        double latency = std::chrono::duration<double, std::micro>(end - start).count();
+        for (size_t jx = responses.size() - data.size(); jx < responses.size(); jx++) {
+            responses[jx].latency = latency;
+        }
+
+        ix += data.size();
+    }
+
+    // a paste at the end is only shown once the input goes quiet
+    host::advance(1000000);
+    host::settle();
+
+    // the responses are printed on exit
+    return 0;
+}
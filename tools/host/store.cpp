@@ -0,0 +1,209 @@
+/**
+ ******************************************************************************
+ * @file    store.cpp
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   ScriptStore test on the host harness.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "ScriptStore.h"
+#include "Host.h"
+
+/* Store ---------------------------------------------------------------------*/
+
+/**
+ * Saves two programs, updates one of them until the old versions have filled
+ * the region three times over, then removes the other. Both programs must
+ * read back after every step, the count and available() must follow, and a
+ * freshly booted ScriptStore must find the same.
+ *
+ * Usage: store [--flash-sectors <count>x<size>,...]
+ */
+
+/* Program sizes, as in a calibration table next to the application. */
+#define STORE_CALIB_SIZE    5000
+#define STORE_PROD_SIZE     3000
+
+/** program
+ * @brief	A program of a given size, which differs with the version.
+ * @param	Name
+ * @param	Version number
+ * @param	Size in bytes
+ */
+static std::string program(const char *name, int number, size_t size) {
+    char line[64];
+    std::string code;
+
+    while (code.size() < size) {
+        snprintf(line, sizeof(line), "var %s%u = %d;\n", name, unsigned(code.size()), number);
+        code += line;
+    }
+    code.resize(size);
+    return code;
+}
+
+/** roundToPages
+ * @brief	Gets the bytes of the whole pages a program takes.
+ */
+static size_t roundToPages(size_t length) {
+    FlashIAP flash;
+    size_t page = flash.get_page_size();
+
+    return (length + page - 1) / page * page;
+}
+
+/** check
+ * @brief	Checks the programs, count and room of a store.
+ * @param	What was just done
+ * @param	Store
+ * @param	Names of the programs it should have
+ * @param	Their code
+ * @param	Bytes of the program region
+ * @return  false if something is off, after printing it
+ */
+static bool check(const std::string &step, ScriptStore &store, const std::vector<std::string> &names,
+                  const std::vector<std::string> &codes, size_t total) {
+    size_t used = 0;
+
+    if (store.size() != names.size()) {
+        printf("%s: %u programs, not %u\n", step.c_str(), unsigned(store.size()), unsigned(names.size()));
+        return false;
+    }
+
+    for (size_t ix = 0; ix < names.size(); ix++) {
+        const char *code;
+        size_t length;
+
+        if (!store.find(names[ix].c_str(), code, length)) {
+            printf("%s: %s not found: %s\n", step.c_str(), names[ix].c_str(), store.getError());
+            return false;
+        }
+        if (std::string(code, length) != codes[ix]) {
+            printf("%s: %s reads back wrong\n", step.c_str(), names[ix].c_str());
+            return false;
+        }
+        used += roundToPages(codes[ix].size());
+    }
+
+    if (store.available() != total - used) {
+        printf("%s: %u bytes available, not %u\n", step.c_str(), unsigned(store.available()),
+               unsigned(total - used));
+        return false;
+    }
+    return true;
+}
+
+/** save
+ * @brief	Saves a program, printing why it failed.
+ */
+static bool save(ScriptStore &store, const std::string &step, const char *name, const std::string &code) {
+    if (!store.save(name, code.data(), code.size())) {
+        printf("%s: saving %s failed: %s\n", step.c_str(), name, store.getError());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--flash-sectors") == 0 && ix + 1 < argc) {
+            std::vector<uint32_t> sectors;
+            const char *spec = argv[++ix];
+            char *next;
+
+            while (*spec) {
+                unsigned long count = strtoul(spec, &next, 0);
+                if (*next != 'x') break;
+                unsigned long size = strtoul(next + 1, &next, 0);
+
+                sectors.insert(sectors.end(), count, (uint32_t)size);
+                spec = *next == ',' ? next + 1 : next;
+            }
+            host::setFlashSectors(sectors.data(), sectors.size());
+        }
+    }
+
+    ScriptStore store;
+    size_t total = store.available();
+    if (total == 0) {
+        printf("no region: %s\n", store.getError());
+        return 1;
+    }
+
+    std::vector<std::string> names;
+    std::vector<std::string> codes;
+
+    names.push_back("calib");
+    codes.push_back(program("calib", 0, STORE_CALIB_SIZE));
+    if (!save(store, "first save", "calib", codes[0])) return 1;
+
+    names.push_back("prod");
+    codes.push_back(program("prod", 0, STORE_PROD_SIZE));
+    if (!save(store, "second save", "prod", codes[1])) return 1;
+    if (!check("two saved", store, names, codes, total)) return 1;
+
+    // the old versions fill the region three times over
+    int updates = int(3 * total / STORE_CALIB_SIZE);
+    size_t erases = host::flashErases();
+
+    for (int number = 1; number <= updates; number++) {
+        char step[32];
+        snprintf(step, sizeof(step), "update %d", number);
+
+        codes[0] = program("calib", number, STORE_CALIB_SIZE);
+        if (!save(store, step, "calib", codes[0]) || !check(step, store, names, codes, total)) return 1;
+    }
+
+    names.pop_back();
+    codes.pop_back();
+    if (!store.remove("prod")) {
+        printf("removing prod failed: %s\n", store.getError());
+        return 1;
+    }
+    if (!check("prod removed", store, names, codes, total)) return 1;
+
+    ScriptStore booted;
+    if (!check("booted", booted, names, codes, total)) return 1;
+
+    printf("%d updates of %u bytes in %u, %u erases\n", updates, unsigned(STORE_CALIB_SIZE), unsigned(total),
+           unsigned(host::flashErases() - erases));
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file    Callback.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Host stand-in for mbed's Callback.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _HOST_CALLBACK_H
+#define _HOST_CALLBACK_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <functional>
+
+/* Class Declaration ---------------------------------------------------------*/
+
+namespace mbed {
+
+template <typename F>
+class Callback;
+
+/**
+ * Callback class which calls a function or a member function of an object,
+ * like mbed::Callback.
+ */
+template <typename R, typename... A>
+class Callback<R(A...)> {
+public:
+    Callback() {
+    }
+
+    Callback(R (*func)(A...)) : func(func) {
+    }
+
+    template <typename T>
+    Callback(T *obj, R (T::*method)(A...)) {
+        func = [obj, method](A... args) { return (obj->*method)(args...); };
+    }
+
+    R operator()(A... args) const {
+        return func(args...);
+    }
+
+    operator bool() const {
+        return bool(func);
+    }
+
+private:
+    std::function<R(A...)> func;
+};
+
+} // namespace mbed
+
+using mbed::Callback;
+
+#endif // _HOST_CALLBACK_H
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @file    jerryscript.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Host stand-in for the JerryScript API used by SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _HOST_JERRYSCRIPT_H
+#define _HOST_JERRYSCRIPT_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Types ---------------------------------------------------------------------*/
+
+typedef uint32_t jerry_value_t;
+typedef uint32_t jerry_size_t;
+typedef uint32_t jerry_length_t;
+typedef uint8_t jerry_char_t;
+
+typedef struct {
+    size_t version;
+    size_t size;
+    size_t allocated_bytes;
+    size_t peak_allocated_bytes;
+    size_t waste_bytes;
+    size_t peak_waste_bytes;
+    size_t byte_code_bytes;
+    size_t peak_byte_code_bytes;
+    size_t string_bytes;
+    size_t peak_string_bytes;
+    size_t object_bytes;
+    size_t peak_object_bytes;
+    size_t property_bytes;
+    size_t peak_property_bytes;
+} jerry_heap_stats_t;
+
+/* Functions -----------------------------------------------------------------*/
+
+/* Programs go to the script set with host::setScript(), values are strings. */
+jerry_value_t jerry_parse(const jerry_char_t *source, size_t length, bool strict);
+jerry_value_t jerry_run(jerry_value_t func);
+jerry_value_t jerry_exec_snapshot(const uint32_t *snapshot, size_t size, bool copy_bytecode);
+
+bool jerry_value_has_error_flag(jerry_value_t value);
+bool jerry_value_is_string(jerry_value_t value);
+bool jerry_value_is_function(jerry_value_t value);
+bool jerry_value_is_array(jerry_value_t value);
+bool jerry_value_is_object(jerry_value_t value);
+jerry_value_t jerry_value_to_string(jerry_value_t value);
+jerry_value_t jerry_acquire_value(jerry_value_t value);
+void jerry_release_value(jerry_value_t value);
+
+jerry_length_t jerry_get_string_length(jerry_value_t value);
+jerry_size_t jerry_substring_to_char_buffer(jerry_value_t value, jerry_length_t start, jerry_length_t end,
+                                            jerry_char_t *buffer, jerry_size_t size);
+uint32_t jerry_get_array_length(jerry_value_t value);
+jerry_value_t jerry_get_property_by_index(jerry_value_t object, uint32_t index);
+jerry_value_t jerry_get_property(jerry_value_t object, jerry_value_t name);
+jerry_value_t jerry_get_object_keys(jerry_value_t object);
+
+bool jerry_get_memory_stats(jerry_heap_stats_t *stats);
+
+#endif // _HOST_JERRYSCRIPT_H
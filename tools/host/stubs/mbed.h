@@ -0,0 +1,233 @@
+/**
+ ******************************************************************************
+ * @file    mbed.h
+ * @author  ST
+ * @version V1.0.0
+ * @date    25 October 2017
+ * @brief   Host stand-in for the parts of mbed OS used by SerialInterface.
+******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT(c) 2017 STMicroelectronics</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of STMicroelectronics nor the names of its contributors
+ *      may be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Prevent recursive inclusion -----------------------------------------------*/
+#ifndef _HOST_MBED_H
+#define _HOST_MBED_H
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <mutex>
+
+#include "Callback.h"
+
+/* Pins ----------------------------------------------------------------------*/
+
+#define USBTX   0
+#define USBRX   1
+
+/* Class Declaration ---------------------------------------------------------*/
+
+/**
+ * RawSerial class which talks to the host harness instead of a UART, see
+ * host::receive() and host::output().
+ */
+class RawSerial {
+public:
+    RawSerial(int tx, int rx, int baud = 9600);
+
+    int putc(int c);
+    int getc();
+    bool readable();
+    void attach(Callback<void()> func);
+    int printf(const char *format, ...);
+};
+
+/**
+ * Timeout class which fires on the harness clock, see host::advance().
+ */
+class Timeout {
+public:
+    Timeout();
+    ~Timeout();
+
+    void attach_us(Callback<void()> func, uint32_t us);
+    void detach();
+
+    /* Harness side. */
+    bool due(uint32_t now);
+    void fire();
+
+private:
+    Callback<void()> func;
+    uint32_t deadline;
+    bool armed;
+};
+
+/**
+ * FlashIAP class backed by RAM, with the sector layout set by
+ * host::setFlashSectors().
+ */
+class FlashIAP {
+public:
+    int init();
+    int deinit();
+    int read(void *buffer, uint32_t addr, uint32_t size);
+    int program(const void *buffer, uint32_t addr, uint32_t size);
+    int erase(uint32_t addr, uint32_t size);
+    uint32_t get_page_size() const;
+    uint32_t get_sector_size(uint32_t addr) const;
+    uint32_t get_flash_start() const;
+    uint32_t get_flash_size() const;
+
+    /* Harness side, see host::setImageSize(). */
+    static uint32_t app_rom_end();
+};
+
+/* End of the firmware image, as FlashIAP.h has it from mbed OS 5.10 on. */
+#define FLASHIAP_APP_ROM_END_ADDR   (FlashIAP::app_rom_end())
+
+/**
+ * PlatformMutex class, recursive like mbed's.
+ */
+class PlatformMutex {
+public:
+    void lock() {
+        mutex.lock();
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+
+private:
+    std::recursive_mutex mutex;
+};
+
+namespace mbed {
+
+/**
+ * FileHandle class with the part of mbed's interface a console needs.
+ */
+class FileHandle {
+public:
+    virtual ~FileHandle() {
+    }
+
+    virtual ssize_t read(void *buffer, size_t size) = 0;
+    virtual ssize_t write(const void *buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+
+    virtual int sync() {
+        return 0;
+    }
+
+    virtual int isatty() {
+        return 0;
+    }
+};
+
+/* The console of the program if not NULL, see host::console(). */
+FileHandle *mbed_override_console(int fd);
+
+} // namespace mbed
+
+using mbed::FileHandle;
+
+/**
+ * CircularBuffer class like mbed's: push() overwrites the oldest element
+ * when full. Safe between the harness threads.
+ */
+template <typename T, uint32_t BufferSize>
+class CircularBuffer {
+public:
+    CircularBuffer() : head(0), tail(0), count(0) {
+    }
+
+    void push(const T &data) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        pool[head] = data;
+        head = (head + 1) % BufferSize;
+        if (count == BufferSize) {
+            tail = (tail + 1) % BufferSize;
+        }
+        else {
+            count++;
+        }
+    }
+
+    bool pop(T &data) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if (count == 0) return false;
+
+        data = pool[tail];
+        tail = (tail + 1) % BufferSize;
+        count--;
+        return true;
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return count == 0;
+    }
+
+    bool full() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return count == BufferSize;
+    }
+
+    uint32_t size() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return count;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> guard(mutex);
+        head = tail = count = 0;
+    }
+
+private:
+    T pool[BufferSize];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t count;
+    std::mutex mutex;
+};
+
+/* Functions -----------------------------------------------------------------*/
+
+void NVIC_SystemReset();
+
+#endif // _HOST_MBED_H
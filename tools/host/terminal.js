@@ -0,0 +1,122 @@
+/**
+ * terminal.js
+ *
+ * Just enough of a VT100 for the host tests: a screen of rows x columns that
+ * the output of SerialInterface is played into. Cursor movements are clamped
+ * at the screen edges and a line feed on the bottom row scrolls, as on a real
+ * terminal. Colours and modes are ignored.
+ */
+
+'use strict';
+
+function Terminal(rows, columns) {
+    this.rows = rows;
+    this.columns = columns;
+    this.screen = [];
+    for (let ix = 0; ix < rows; ix++) this.screen.push(this.blank());
+    this.row = 0;
+    this.column = 0;
+    this.saved = [0, 0];
+}
+
+Terminal.prototype.blank = function () {
+    return new Array(this.columns).fill(' ');
+};
+
+Terminal.prototype.write = function (data) {
+    const text = data.toString('latin1');
+    let ix = 0;
+
+    while (ix < text.length) {
+        const c = text[ix];
+
+        if (c === '\x1b') {
+            const match = /^\x1b(?:([78])|\[([?]?)([0-9;]*)([@-~]))/.exec(text.slice(ix));
+            if (!match) {
+                ix++;
+                continue;
+            }
+
+            if (match[1]) this.escape(match[1]);
+            else if (!match[2]) this.control(match[4], match[3].split(';').map(p => parseInt(p, 10) || 0));
+            ix += match[0].length;
+            continue;
+        }
+
+        if (c === '\r') this.column = 0;
+        else if (c === '\n') this.lineFeed();
+        else if (c === '\b') this.column = Math.max(0, this.column - 1);
+        else if (c === '\t') this.column = Math.min(this.columns - 1, (Math.floor(this.column / 8) + 1) * 8);
+        else if (c >= ' ') {
+            this.screen[this.row][this.column] = c;
+            this.column = Math.min(this.columns - 1, this.column + 1);
+        }
+        ix++;
+    }
+};
+
+Terminal.prototype.lineFeed = function () {
+    if (this.row === this.rows - 1) {
+        this.screen.shift();
+        this.screen.push(this.blank());
+    }
+    else {
+        this.row++;
+    }
+};
+
+Terminal.prototype.escape = function (c) {
+    if (c === '7') this.saved = [this.row, this.column];
+    else {
+        this.row = this.saved[0];
+        this.column = this.saved[1];
+    }
+};
+
+Terminal.prototype.control = function (final, params) {
+    const n = Math.max(1, params[0]);
+    const clamp = (value, max) => Math.max(0, Math.min(max - 1, value));
+
+    switch (final) {
+        case 'A': this.row = clamp(this.row - n, this.rows); break;
+        case 'B': this.row = clamp(this.row + n, this.rows); break;
+        case 'C': this.column = clamp(this.column + n, this.columns); break;
+        case 'D': this.column = clamp(this.column - n, this.columns); break;
+        case 'G': this.column = clamp(n - 1, this.columns); break;
+        case 'H':
+            this.row = clamp(n - 1, this.rows);
+            this.column = clamp(Math.max(1, params[1] || 0) - 1, this.columns);
+            break;
+        case 'J':
+            for (let ix = this.column; ix < this.columns; ix++) this.screen[this.row][ix] = ' ';
+            for (let ix = this.row + 1; ix < this.rows; ix++) this.screen[ix] = this.blank();
+            break;
+        case 'K':
+            for (let ix = this.column; ix < this.columns; ix++) this.screen[this.row][ix] = ' ';
+            break;
+        case 'L':
+            for (let ix = 0; ix < n; ix++) {
+                this.screen.splice(this.row, 0, this.blank());
+                this.screen.pop();
+            }
+            this.column = 0;
+            break;
+        case 'M':
+            for (let ix = 0; ix < n; ix++) {
+                this.screen.splice(this.row, 1);
+                this.screen.push(this.blank());
+            }
+            this.column = 0;
+            break;
+        default:
+            // colours, modes and reports
+            break;
+    }
+};
+
+// the text of a screen row, without trailing blanks
+Terminal.prototype.line = function (row) {
+    return this.screen[row].join('').replace(/ +$/, '');
+};
+
+module.exports = Terminal;
@@ -0,0 +1,575 @@
+#!/usr/bin/env node
+/**
+ * test.js
+ *
+ * Builds the host programs (see build.sh) into tools/host/build and runs the
+ * host tests of SerialInterface:
+ *
+ *   replay   a session recorded with SERIAL_INTERFACE_TRACE, dumped with
+ *            Ctrl+T and replayed by trace-replay.js --host, gives the same
+ *            output; an altered trace is reported as diverging
+ *   screen   a 200 line program edited in a 16 row terminal and recalled
+ *            from history: the rows on screen always show the lines around
+ *            the cursor
+ *   editor   keys typed while a program runs and prints are echoed, the
+ *            printed lines go above the editor, and input that overflows the
+ *            receive ring is reported (SERIAL_INTERFACE_EDITOR_THREAD only)
+ *   flash    a program is saved (ScriptStore) and flashed (ScriptFlash) on
+ *            STM32 sector layouts; the default regions refuse 128 KB sectors
+ *            unless SCRIPT_*_SECTORS is set, and no region may overlap the
+ *            firmware image
+ *   store    ScriptStore keeps two programs while one of them is updated
+ *            until the region has filled three times over, then the other is
+ *            removed; count and available() follow (without
+ *            SERIAL_INTERFACE_EDITOR_THREAD only)
+ *   journal  ScriptFlash loses power after each flash operation of an update,
+ *            again and again as its header journal moves between sectors, and
+ *            always boots the old program or none while the update is pending
+ *            (without SERIAL_INTERFACE_EDITOR_THREAD only)
+ *   snapshot snapshot frames with a bad CRC, version or size are reported and
+ *            never reach the editor; after a bad size the next frame is
+ *            found by its magic
+ *   profiler Ctrl+P profiles runs and lists them on the next toggle; the
+ *            Profiler ring keeps the last PROFILER_RUNS runs, oldest first,
+ *            with and without PROFILER_HEAP_STATS
+ *   printer  ResultPrinter prints nested arrays and objects, cycles and
+ *            multi-byte strings through its depth, element and byte limits
+ *            (without SERIAL_INTERFACE_EDITOR_THREAD only)
+ *   highlight random edits, most of them opening or closing strings and
+ *            comments, leave the incrementally updated tokens the same as a
+ *            full rebuild, and every colour change outside the edit inside
+ *            the span to repaint (without SERIAL_INTERFACE_EDITOR_THREAD only)
+ *   framed   with SERIAL_INTERFACE_FRAMED, what a program prints arrives in
+ *            frames on the O channel, and mux-terminal.js gets back in step
+ *            after a start byte that doesn't start a frame
+ *
+ * Every test runs with and without SERIAL_INTERFACE_EDITOR_THREAD, tests that
+ * need one of them are skipped with the other.
+ *
+ * Usage: node tools/host/test.js [test name...]
+ */
+
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+const childProcess = require('child_process');
+
+const Terminal = require('./terminal');
+const Demux = require('../mux-terminal').Demux;
+const snapshotUpload = require('../snapshot-upload');
+
+const HOST = __dirname;
+const BUILD = path.join(HOST, 'build');
+
+const CONFIGS = [
+    { name: 'plain', flags: [] },
+    { name: 'editor-thread', flags: ['-DSERIAL_INTERFACE_EDITOR_THREAD'] }
+];
+
+// once per run of the tests
+const built = {};
+
+function build(program, name, flags) {
+    const output = path.join(BUILD, name);
+    if (built[output]) return output;
+
+    built[output] = true;
+    childProcess.execFileSync(path.join(HOST, 'build.sh'), [output, path.join(HOST, program)].concat(flags),
+        { stdio: 'inherit' });
+    return output;
+}
+
+function run(binary, args, input) {
+    return childProcess.spawnSync(binary, args, { input: input, maxBuffer: 1 << 28, timeout: 120000 });
+}
+
+// "<time> <byte>" lines for keys typed gap us apart
+function Session() {
+    this.time = 0x100000;
+    this.lines = [];
+}
+
+Session.prototype.keys = function (text, gap) {
+    for (const c of Buffer.from(text, 'latin1')) {
+        this.time += gap;
+        this.lines.push(this.time.toString(16) + ' ' + c.toString(16));
+    }
+    return this;
+};
+
+// number of keys so far, to look at the screen after them
+Session.prototype.mark = function () {
+    return this.lines.length;
+};
+
+Session.prototype.toString = function () {
+    return this.lines.join('\n') + '\n';
+};
+
+// what the terminal showed, from the replay program's responses
+function terminalLog(stdout) {
+    return Buffer.concat(stdout.toString().split('\n').filter(l => l.length > 0)
+        .map(l => Buffer.from(l.split(' ')[2] || '', 'hex')));
+}
+
+// the boot output and the output after each key, from the replay program
+function responses(stdout) {
+    return stdout.toString().split('\n').filter(l => l.length > 0)
+        .map(l => Buffer.from(l.split(' ')[2] || '', 'hex'));
+}
+
+// the rows around the cursor show the program, and the cursor is where expected
+function checkScreen(term, program, line, column) {
+    for (let row = 0; row < term.rows; row++) {
+        const ix = line + row - term.row;
+        if (ix < 0) continue;
+
+        const expected = (ix < program.length ? (ix === 0 ? '> ' : '') + program[ix] : '').replace(/ +$/, '');
+        if (term.line(row) !== expected) {
+            return 'row ' + row + ' shows "' + term.line(row) + '", not line ' + ix + ' "' + expected + '"';
+        }
+    }
+
+    const expected = (line === 0 ? 2 : 0) + column;
+    if (term.column !== expected) return 'cursor in column ' + term.column + ', not ' + expected;
+    return null;
+}
+
+function testScreen(config) {
+    const replay = build('replay.cpp', 'replay-' + config.name, ['-DSERIAL_INTERFACE_TRACE'].concat(config.flags));
+    const ROWS = 16;
+    const program = [];
+    for (let ix = 0; ix < 200; ix++) program.push('var v' + ix + ' = ' + ix + ';');
+
+    const session = new Session().keys('\x1b[' + ROWS + ';80R', 150000);
+    const checks = [];
+    const check = (line, column, what) => {
+        checks.push({ mark: session.mark(), program: program.slice(), line: line, column: column, what: what });
+    };
+    const keys = (text, count) => {
+        for (let ix = 0; ix < count; ix++) session.keys(text, 150000);
+    };
+
+    session.keys(program.join('\r'), 100);
+    check(199, 15, 'after the paste');
+
+    keys('\x1b[A', 150);
+    check(49, 13, 'up to line 49');
+    keys('\x1b[A', 49);
+    check(0, 11, 'up to line 0');
+    keys('\x1b[B', 120);
+    check(120, 11, 'down to line 120');
+
+    keys('\x1b[D', 4);
+    keys('\r', 1);
+    program.splice(120, 1, 'var v12', '0 = 120;');
+    check(121, 0, 'line 120 split');
+    keys('\x7f', 1);
+    program.splice(120, 2, 'var v120 = 120;');
+    check(120, 7, 'line 120 joined');
+
+    keys('\x0b', 1);
+    keys('\x1b[A', 30);
+    keys('/*', 1);
+    program[90] = 'var v90/* = 90;';
+    check(90, 9, 'comment opened, highlighted');
+    keys('\x1b[B', 60);
+    check(150, 9, 'down to line 150, highlighted');
+    keys('\x0b', 1);
+
+    // run, then the program comes back from history, and goes again
+    keys('\x12', 1);
+    keys('\x1b[A', 1);
+    check(199, 15, 'recalled from history');
+    keys('\x1b[B', 1);
+    checks.push({ mark: session.mark(), program: [''], line: 0, column: 0, what: 'history left' });
+
+    // started from a prompt, line 0 is printed after it
+    const replayed = run(replay, ['--prompt'], session.toString());
+    if (replayed.status !== 0) return 'replay failed';
+
+    const output = responses(replayed.stdout);
+    const term = new Terminal(ROWS, 200);
+    let fed = 0;
+
+    // output[0] is the boot output, output[n] the response to key n - 1
+    for (const step of checks) {
+        while (fed <= step.mark) term.write(output[fed++]);
+
+        const error = checkScreen(term, step.program, step.line, step.column);
+        if (error) return step.what + ': ' + error;
+    }
+
+    return null;
+}
+
+function testEditor(config) {
+    if (config.flags.indexOf('-DSERIAL_INTERFACE_EDITOR_THREAD') < 0) return SKIP;
+
+    const replay = build('replay.cpp', 'replay-' + config.name, ['-DSERIAL_INTERFACE_TRACE'].concat(config.flags));
+    const ROWS = 16;
+    const program = 'host.print("tick 1"); host.sleep(500); host.print("tick 2"); host.sleep(500);';
+    const typed = 'var typed = 1;';
+
+    const session = new Session()
+        .keys('\x1b[' + ROWS + ';80R', 150000)
+        .keys(program, 100)
+        .keys('\x12', 150000);            // run, for a second
+
+    // typed while it runs, 40 ms apart
+    session.keys(typed.slice(0, 5), 40000);
+    const running = session.mark();
+    session.keys(typed.slice(5), 40000)
+        .keys('\x1b[C', 1000000);         // after it ended, nothing to the right
+    const ended = session.mark();
+
+    // more than the receive ring holds, in one interrupt
+    session.time += 150000;
+    for (let ix = 0; ix < 300; ix++) session.lines.push(session.time.toString(16) + ' 20');
+
+    const replayed = run(replay, ['--prompt', '--loop-thread'], session.toString());
+    if (replayed.status !== 0) return 'replay failed';
+
+    const output = responses(replayed.stdout);
+    const term = new Terminal(ROWS, 200);
+    let fed = 0;
+    const feed = mark => {
+        while (fed <= mark) term.write(output[fed++]);
+    };
+
+    // the editor goes on without a prompt until the result is in
+    feed(running);
+    if (term.line(term.row) !== typed.slice(0, 5) || term.column !== 5) {
+        return 'typing not echoed while running: "' + term.line(term.row) + '" column ' + term.column;
+    }
+    if (term.line(term.row - 1) !== 'tick 1') {
+        return 'printed line not above the editor: "' + term.line(term.row - 1) + '"';
+    }
+
+    feed(ended);
+    const expected = ['> ' + program, 'tick 1', 'tick 2', 'undefined', '>', typed];
+    for (let ix = 0; ix < expected.length; ix++) {
+        const row = term.row - expected.length + 1 + ix;
+        if (term.line(row) !== expected[ix]) {
+            return 'after the run, row ' + row + ' shows "' + term.line(row) + '", not "' + expected[ix] + '"';
+        }
+    }
+    if (term.column !== typed.length) return 'cursor in column ' + term.column + ' after the run';
+
+    feed(output.length - 1);
+    const reported = /#input overflow, (\d+) characters dropped/.exec(term.line(term.row - 1));
+    if (!reported) return 'overflow not reported: "' + term.line(term.row - 1) + '"';
+    if (term.line(term.row) !== typed) {
+        return 'editor not painted again after the overflow: "' + term.line(term.row) + '"';
+    }
+
+    return null;
+}
+
+function testFlash(config) {
+    const features = ['-DSERIAL_INTERFACE_SCRIPT_FLASH', '-DSERIAL_INTERFACE_SCRIPT_STORE'].concat(config.flags);
+    const builds = {
+        default: build('replay.cpp', 'replay-flash-' + config.name, features),
+        sectors: build('replay.cpp', 'replay-flash-sectors-' + config.name,
+            features.concat(['-DSCRIPT_FLASH_SECTORS=3', '-DSCRIPT_STORE_SECTORS=4']))
+    };
+    const LAYOUTS = {
+        'STM32F4, 1 MB': '4x0x4000,1x0x10000,7x0x20000',
+        'STM32F7, 2 MB': '4x0x8000,1x0x20000,7x0x40000',
+        'STM32F401RE, 512 KB': '4x0x4000,1x0x10000,3x0x20000',
+        'STM32L4, 1 MB': '512x0x800'
+    };
+    // what each build makes of each layout, with a 100 KB firmware image
+    const CASES = [
+        { build: 'default', layout: 'STM32L4, 1 MB' },
+        {
+            build: 'default', layout: 'STM32F4, 1 MB',
+            store: 'sectors too big, set SCRIPT_FLASH_SECTORS', flash: 'sectors too big, set SCRIPT_FLASH_SECTORS'
+        },
+        { build: 'sectors', layout: 'STM32F4, 1 MB' },
+        { build: 'sectors', layout: 'STM32F7, 2 MB' },
+        // the store reaches down to 0x0800c000
+        { build: 'sectors', layout: 'STM32F401RE, 512 KB', store: 'region overlaps firmware' }
+    ];
+
+    // Ctrl+F resets the board, last
+    const session = new Session()
+        .keys('var a = 1;', 150000)
+        .keys('\x0fsave a\r\x03', 150000)
+        .keys('\x06', 150000);
+
+    for (const test of CASES) {
+        const name = test.build + ' build, ' + test.layout;
+        const replayed = run(builds[test.build], ['--flash-sectors', LAYOUTS[test.layout], '--image-size', '102400'],
+            session.toString());
+        if (replayed.status !== 0) return name + ': replay failed';
+
+        const log = terminalLog(replayed.stdout).toString('latin1');
+        const saved = test.store ? '#script error ' + test.store : '#script saved a, 10 bytes';
+        const flashed = test.flash ? 'Flashing failed: ' + test.flash : '#flash 1 of 1 sectors written, 0 skipped';
+        if (log.indexOf(saved) < 0) return name + ': no "' + saved + '": ' + JSON.stringify(log.slice(-200));
+        if (log.indexOf(flashed) < 0) return name + ': no "' + flashed + '": ' + JSON.stringify(log.slice(-200));
+    }
+
+    return null;
+}
+
+function testStore(config) {
+    // ScriptStore alone, the editor makes no difference
+    if (config.flags.length > 0) return SKIP;
+
+    const features = ['-DSERIAL_INTERFACE_SCRIPT_FLASH', '-DSERIAL_INTERFACE_SCRIPT_STORE'];
+    const CASES = [
+        { layout: 'STM32L4, 1 MB', sectors: '512x0x800', flags: [] },
+        {
+            layout: 'STM32F4, 1 MB', sectors: '4x0x4000,1x0x10000,7x0x20000',
+            flags: ['-DSCRIPT_FLASH_SECTORS=3', '-DSCRIPT_STORE_SECTORS=4']
+        }
+    ];
+
+    for (const test of CASES) {
+        const store = build('store.cpp', 'store' + (test.flags.length ? '-sectors' : ''), features.concat(test.flags));
+        const result = run(store, ['--flash-sectors', test.sectors], '');
+        if (result.status !== 0) return test.layout + ': ' + (result.stdout.toString() + result.stderr.toString()).trim();
+    }
+
+    return null;
+}
+
+function testJournal(config) {
+    // ScriptFlash alone, the editor makes no difference
+    if (config.flags.length > 0) return SKIP;
+
+    const journal = build('journal.cpp', 'journal', []);
+    const result = run(journal, [], '');
+    if (result.status !== 0) return (result.stdout.toString() + result.stderr.toString()).trim() || 'journal failed';
+
+    return null;
+}
+
+function testSnapshot(config) {
+    const replay = build('replay.cpp', 'replay-' + config.name, ['-DSERIAL_INTERFACE_TRACE'].concat(config.flags));
+    const frame = (action, payload) => snapshotUpload.frame(action, Buffer.from(payload, 'latin1'));
+    const typed = frame => frame.toString('latin1');
+
+    const badCrc = frame(snapshotUpload.PARSE, 'zz = 1;');
+    badCrc[badCrc.length - 1] ^= 1;
+    // a snapshot made for version 5, its header says so too
+    const badVersion = frame(snapshotUpload.RUN, '\x05\x00\x00\x00zzzzzzzz');
+    const badSize = frame(snapshotUpload.PARSE, 'zz = 1;');
+    badSize.writeUInt32LE(0x7fffffff, 13);
+
+    // the rest of a frame with a bad size, a false start of a magic, then the next frame
+    const resync = typed(badSize) + 'zz JSN zz ' + typed(frame(snapshotUpload.PARSE, '2 + 2'));
+
+    // frames at 100 us a byte, the loader gives up after a second of quiet
+    const session = new Session();
+    for (const sent of [typed(frame(snapshotUpload.PARSE, '1 + 1')), typed(badCrc), typed(badVersion), resync]) {
+        session.time += 150000;
+        session.keys(sent, 100);
+    }
+    session.keys('var a = 1;', 150000);
+
+    const replayed = run(replay, ['--prompt'], session.toString());
+    if (replayed.status !== 0) return 'replay failed';
+
+    const log = terminalLog(replayed.stdout).toString('latin1');
+    const expected = ['#snapshot ok P 5 ', '#snapshot error crc mismatch', '#snapshot error version mismatch',
+        '#snapshot error bad size', '#snapshot ok P 5 '];
+    let at = 0;
+    for (const line of expected) {
+        const found = log.indexOf(line, at);
+        if (found < 0) return 'no "' + line + '" after ' + JSON.stringify(log.slice(at, at + 200));
+        at = found + line.length;
+    }
+
+    const term = new Terminal(24, 200);
+    term.write(Buffer.from(log, 'latin1'));
+    // the editor is back below the last result, holding only what was typed
+    if (term.line(term.row - 1) !== '>' || term.line(term.row) !== 'var a = 1;') {
+        return 'frames reached the editor: "' + term.line(term.row - 1) + '", "' + term.line(term.row) + '"';
+    }
+
+    return null;
+}
+
+function testProfiler(config) {
+    const replay = build('replay.cpp', 'replay-' + config.name, ['-DSERIAL_INTERFACE_TRACE'].concat(config.flags));
+
+    const session = new Session()
+        .keys('\x10', 150000)
+        .keys('var a = 1;', 150000)
+        .keys('\x12', 150000)
+        .keys('\x10', 150000);
+
+    const replayed = run(replay, ['--prompt'], session.toString());
+    if (replayed.status !== 0) return 'replay failed';
+
+    // the host clock stands still while a program runs
+    const line = '#profile ok parse 0 us, run 0 us, heap -, 10 B of code\r\n';
+    const log = terminalLog(replayed.stdout).toString('latin1');
+    const expected = ['profiling on\r\n', line, 'profiling off\r\n' + line];
+    let at = 0;
+    for (const text of expected) {
+        const found = log.indexOf(text, at);
+        if (found < 0) return 'no ' + JSON.stringify(text) + ' after ' + JSON.stringify(log.slice(at, at + 200));
+        at = found + text.length;
+    }
+
+    // the ring alone, the editor makes no difference
+    if (config.flags.length > 0) return null;
+
+    for (const heap of [false, true]) {
+        const profiler = build('profiler.cpp', 'profiler' + (heap ? '-heap' : ''),
+            ['-DPROFILER_RUNS=4'].concat(heap ? ['-DPROFILER_HEAP_STATS'] : []));
+        const result = run(profiler, [], '');
+        if (result.status !== 0) {
+            return (heap ? 'heap stats: ' : '') + ((result.stdout.toString() + result.stderr.toString()).trim() || 'profiler failed');
+        }
+    }
+
+    return null;
+}
+
+function testPrinter(config) {
+    // ResultPrinter alone, the editor makes no difference
+    if (config.flags.length > 0) return SKIP;
+
+    const printer = build('printer.cpp', 'printer', []);
+    const result = run(printer, [], '');
+    if (result.status !== 0) return (result.stdout.toString() + result.stderr.toString()).trim() || 'printer failed';
+
+    return null;
+}
+
+function testHighlight(config) {
+    // Highlighter alone, the editor makes no difference
+    if (config.flags.length > 0) return SKIP;
+
+    const highlight = build('highlight.cpp', 'highlight', []);
+    const result = run(highlight, [], '');
+    if (result.status !== 0) return (result.stdout.toString() + result.stderr.toString()).trim() || 'highlight failed';
+
+    return null;
+}
+
+// the payloads of each channel, and the bytes outside of frames
+function demultiplex(chunks) {
+    const channels = { raw: '' };
+    const handlers = { raw: payload => { channels.raw += payload.toString('latin1'); } };
+    for (const channel of 'ELOD') {
+        channels[channel] = '';
+        handlers[channel] = payload => { channels[channel] += payload.toString('latin1'); };
+    }
+
+    const demux = new Demux(handlers);
+    chunks.forEach(chunk => demux.add(chunk));
+    return channels;
+}
+
+function testFramed(config) {
+    const replay = build('replay.cpp', 'replay-framed-' + config.name, ['-DSERIAL_INTERFACE_FRAMED'].concat(config.flags));
+
+    const session = new Session()
+        .keys('host.print("tick 1"); host.print("tick 2");', 150000)
+        .keys('\x12', 150000);
+
+    const replayed = run(replay, [], session.toString());
+    if (replayed.status !== 0) return 'replay failed';
+
+    const channels = demultiplex(responses(replayed.stdout));
+    if (channels.raw !== '') return 'bytes outside of frames: ' + JSON.stringify(channels.raw);
+    if (!/^tick 1\r\ntick 2\r\n.*undefined/.test(channels.O)) {
+        return 'console output not on the O channel: ' + JSON.stringify(channels.O);
+    }
+
+    // a start byte of plain output, then a frame
+    const stray = demultiplex([Buffer.from('ok \x1ex\x1e'), Buffer.from('O\x03abc')]);
+    if (stray.raw !== 'ok \x1ex' || stray.O !== 'abc') {
+        return 'stray start byte not taken as output: ' + JSON.stringify(stray);
+    }
+
+    return null;
+}
+
+function testReplay(config) {
+    const replay = build('replay.cpp', 'replay-' + config.name, ['-DSERIAL_INTERFACE_TRACE'].concat(config.flags));
+
+    const session = new Session()
+        .keys('var a = 1;\r', 150000)
+        .keys('b = 2;\rc = 3;', 100)       // pasted, ends on a timeout
+        .keys('\x1b[D\x1b[D\x7f', 150000)
+        .keys('\x12', 150000)              // run
+        .keys('x', 150000)
+        .keys('\x14', 150000);             // dump
+
+    const recorded = run(replay, [], session.toString());
+    if (recorded.status !== 0) return 'recording failed';
+
+    const log = terminalLog(recorded.stdout);
+    const logFile = path.join(BUILD, 'replay-' + config.name + '.log');
+    fs.writeFileSync(logFile, log);
+
+    const tool = path.join(HOST, '..', 'trace-replay.js');
+    const replayed = run(process.execPath, [tool, logFile, '--host', replay]);
+    if (replayed.status !== 0 || !/output matches/.test(replayed.stdout)) {
+        return 'replay differs:\n' + replayed.stdout + replayed.stderr;
+    }
+
+    // one echoed byte changed in the recording
+    const altered = log.toString('latin1').replace(/ T 78\r\n/, ' T 79\r\n');
+    fs.writeFileSync(logFile, altered, 'latin1');
+
+    const diverged = run(process.execPath, [tool, logFile, '--host', replay]);
+    if (diverged.status !== 1 || !/output diverges at RX #\d+ 0x78/.test(diverged.stdout)) {
+        return 'altered trace not reported:\n' + diverged.stdout + diverged.stderr;
+    }
+
+    return null;
+}
+
+// a test returns null when it passes, an error, or this when it does not apply
+const SKIP = {};
+
+const TESTS = {
+    replay: testReplay,
+    screen: testScreen,
+    editor: testEditor,
+    flash: testFlash,
+    store: testStore,
+    journal: testJournal,
+    snapshot: testSnapshot,
+    profiler: testProfiler,
+    printer: testPrinter,
+    highlight: testHighlight,
+    framed: testFramed
+};
+
+function main(argv) {
+    const names = argv.length > 0 ? argv : Object.keys(TESTS);
+    let failed = 0;
+
+    fs.mkdirSync(BUILD, { recursive: true });
+
+    names.forEach(name => {
+        if (!TESTS[name]) {
+            console.error('no test %s', name);
+            process.exit(2);
+        }
+
+        CONFIGS.forEach(config => {
+            const error = TESTS[name](config);
+            if (error === SKIP) {
+                console.log('skip %s (%s)', name, config.name);
+                return;
+            }
+            console.log('%s %s (%s)%s', error ? 'FAIL' : 'ok  ', name, config.name, error ? ': ' + error : '');
+            if (error) failed++;
+        });
+    });
+
+    process.exit(failed ? 1 : 0);
+}
+
+main(process.argv.slice(2));
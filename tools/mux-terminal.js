@@ -0,0 +1,209 @@
+#!/usr/bin/env node
+/**
+ * mux-terminal.js
+ *
+ * Terminal for a device built with SERIAL_INTERFACE_FRAMED. The device sends
+ * every write as a frame of a start byte (0x1e), a channel, a length and the
+ * payload; this tool splits them up again:
+ *
+ *   E  editor   shown in the bottom pane, as the device paints it
+ *   O  stdout   results and console output, top pane
+ *   L  log      errors, top pane in yellow
+ *   D  data     binary data, appended to --data <file> or summed up in the top pane
+ *
+ * Bytes outside of frames, e.g. output from before SerialInterface was
+ * created, go to the top pane as they are; a start byte not followed by a
+ * known channel is taken as one of them, so a stray one doesn't throw the
+ * rest of the session off. Keys are sent to the device unchanged, Ctrl+]
+ * quits. The device is told the height of the editor pane, as a cursor
+ * position report.
+ *
+ * Configure the port first, e.g. `stty -F <port> raw 115200`.
+ *
+ * Usage: node tools/mux-terminal.js --port <device> [--editor-rows <n>] [--data <file>]
+ */
+
+'use strict';
+
+const fs = require('fs');
+const tty = require('tty');
+
+// must match ChannelMux on the device
+const START = 0x1e;
+const EDITOR = 'E';
+const STDOUT = 'O';
+const LOG = 'L';
+const DATA = 'D';
+const CHANNELS = [EDITOR, STDOUT, LOG, DATA];
+
+const QUIT = 0x1d;
+
+function Screen(editorRows) {
+    this.editorRows = editorRows;
+    this.layout();
+}
+
+// output pane on top, the editor scrolls in the bottom pane
+Screen.prototype.layout = function () {
+    const rows = process.stdout.rows || 24;
+
+    this.rows = rows;
+    this.split = Math.max(1, rows - Math.min(this.editorRows, rows - 1));
+
+    // origin mode, the editor's cursor home is the top of its pane
+    process.stdout.write('\x1b[2J\x1b[' + (this.split + 1) + ';' + rows + 'r\x1b[?6h\x1b[H');
+};
+
+// what the terminal would answer to a cursor position request in the editor pane
+Screen.prototype.sizeReport = function () {
+    return '\x1b[' + (this.rows - this.split) + ';' + (process.stdout.columns || 80) + 'R';
+};
+
+Screen.prototype.editor = function (data) {
+    process.stdout.write(data);
+};
+
+// prints a line at the bottom of the output pane, the editor cursor stays put
+Screen.prototype.output = function (line, colour) {
+    process.stdout.write('\x1b7\x1b[1;' + this.split + 'r\x1b[' + this.split + ';1H\r\n' +
+        (colour ? '\x1b[' + colour + 'm' + line + '\x1b[0m' : line) +
+        '\x1b[' + (this.split + 1) + ';' + this.rows + 'r\x1b8');
+};
+
+Screen.prototype.restore = function () {
+    process.stdout.write('\x1b[?6l\x1b[r\x1b[' + this.rows + ';1H\r\n');
+};
+
+// collects the text of a channel into lines
+function Lines(screen, colour) {
+    this.screen = screen;
+    this.colour = colour;
+    this.text = '';
+}
+
+Lines.prototype.add = function (data) {
+    this.text += data.toString('latin1');
+
+    let end;
+    while ((end = this.text.indexOf('\n')) >= 0) {
+        this.screen.output(this.text.slice(0, end).replace(/\r/g, ''), this.colour);
+        this.text = this.text.slice(end + 1);
+    }
+};
+
+function Demux(handlers) {
+    this.handlers = handlers;
+    this.state = 'idle';
+    this.channel = '';
+    this.left = 0;
+    this.payload = [];
+}
+
+Demux.prototype.add = function (chunk) {
+    let raw = 0;
+
+    for (let ix = 0; ix < chunk.length; ix++) {
+        const c = chunk[ix];
+
+        if (this.state === 'idle') {
+            if (c === START) {
+                if (raw < ix) this.handlers.raw(chunk.slice(raw, ix));
+                this.state = 'channel';
+            }
+            continue;
+        }
+
+        if (this.state === 'channel') {
+            this.channel = String.fromCharCode(c);
+
+            if (CHANNELS.indexOf(this.channel) < 0) {
+                // not a frame after all, the start byte was output of its own
+                this.handlers.raw(Buffer.from([START]));
+                this.state = 'idle';
+                raw = ix;
+                ix--;
+                continue;
+            }
+            this.state = 'length';
+        }
+        else if (this.state === 'length') {
+            this.left = c;
+            this.payload = [];
+            this.state = c ? 'payload' : 'idle';
+        }
+        else {
+            // the rest of the payload in one go
+            const count = Math.min(this.left, chunk.length - ix);
+            this.payload.push(chunk.slice(ix, ix + count));
+            this.left -= count;
+            ix += count - 1;
+
+            if (this.left === 0) {
+                const handler = this.handlers[this.channel] || this.handlers.raw;
+                handler(Buffer.concat(this.payload));
+                this.state = 'idle';
+            }
+        }
+        raw = ix + 1;
+    }
+
+    if (this.state === 'idle' && raw < chunk.length) this.handlers.raw(chunk.slice(raw));
+};
+
+function main(argv) {
+    const args = { editorRows: 10 };
+    for (let ix = 0; ix < argv.length; ix++) {
+        if (argv[ix] === '--port') args.port = argv[++ix];
+        else if (argv[ix] === '--editor-rows') args.editorRows = parseInt(argv[++ix], 10);
+        else if (argv[ix] === '--data') args.data = argv[++ix];
+    }
+
+    if (!args.port || !(args.editorRows > 0)) {
+        console.error('usage: mux-terminal.js --port <device> [--editor-rows <n>] [--data <file>]');
+        process.exit(2);
+    }
+
+    const screen = new Screen(args.editorRows);
+    const stdout = new Lines(screen, '');
+    const log = new Lines(screen, '33'); // yellow
+    const data = args.data ? fs.openSync(args.data, 'a') : null;
+
+    const handlers = {};
+    handlers[EDITOR] = payload => screen.editor(payload);
+    handlers[STDOUT] = payload => stdout.add(payload);
+    handlers[LOG] = payload => log.add(payload);
+    handlers[DATA] = payload => {
+        if (data !== null) fs.writeSync(data, payload);
+        else screen.output('data: ' + payload.length + ' bytes ' + payload.toString('hex').replace(/(..)/g, '$1 ').trim(), '36');
+    };
+    handlers.raw = payload => stdout.add(payload);
+
+    const demux = new Demux(handlers);
+    // a tty stream, a plain file stream would keep a thread blocked on exit
+    const port = fs.openSync(args.port, 'r+');
+    const input = new tty.ReadStream(port);
+
+    input.on('data', chunk => demux.add(chunk));
+    fs.writeSync(port, screen.sizeReport());
+
+    process.stdin.setRawMode(true);
+    process.stdin.on('data', keys => {
+        if (keys.indexOf(QUIT) >= 0) {
+            screen.restore();
+            process.exit(0);
+        }
+        fs.writeSync(port, keys);
+    });
+
+    process.stdout.on('resize', () => {
+        screen.layout();
+        fs.writeSync(port, screen.sizeReport());
+    });
+}
+
+if (require.main === module) {
+    main(process.argv.slice(2));
+}
+
+// for the host tests
+module.exports = { Demux: Demux };
@@ -0,0 +1,178 @@
+#!/usr/bin/env node
+/**
+ * snapshot-upload.js
+ *
+ * Compiles a JavaScript file into a JerryScript snapshot with the desktop
+ * build of JerryScript (`jerry --save-snapshot-for-global`) and sends it to
+ * the device, which checks its version and CRC and runs it. A prebuilt
+ * .snapshot file is sent as is.
+ *
+ * With --compare the source is sent as well, so the device parses it the
+ * usual way; both load times are reported side by side. Use --runs to
+ * repeat the measurement.
+ *
+ * With --out the snapshot frame is written to a file instead of a port.
+ *
+ * Configure the port first, e.g. `stty -F <port> raw 115200`.
+ *
+ * Usage: node tools/snapshot-upload.js <file.js|file.snapshot> (--port <device> | --out <file>)
+ *            [--jerry <path>] [--compare] [--runs <n>] [--timeout <ms>]
+ */
+
+'use strict';
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const childProcess = require('child_process');
+
+// must match SnapshotLoader on the device
+const START = 0x02;
+const MAGIC = 'JSNP';
+const RUN = 'R';
+const PARSE = 'P';
+
+function crc32(data) {
+    let crc = 0xffffffff;
+    for (let ix = 0; ix < data.length; ix++) {
+        crc ^= data[ix];
+        for (let bit = 0; bit < 8; bit++) {
+            crc = (crc >>> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return (crc ^ 0xffffffff) >>> 0;
+}
+
+function compile(jerry, file) {
+    const out = path.join(os.tmpdir(), 'snapshot-upload-' + process.pid + '.snapshot');
+
+    childProcess.execFileSync(jerry, ['--save-snapshot-for-global', out, file], { stdio: 'inherit' });
+
+    const snapshot = fs.readFileSync(out);
+    fs.unlinkSync(out);
+    return snapshot;
+}
+
+function frame(action, payload) {
+    const header = Buffer.alloc(21);
+
+    header[0] = START;
+    header.write(MAGIC, 1, 'latin1');
+    header.write(action, 5, 'latin1');
+    // the snapshot's own header starts with its version, plain source has none
+    header.writeUInt32LE(action === RUN ? payload.readUInt32LE(0) : 0, 9);
+    header.writeUInt32LE(payload.length, 13);
+    header.writeUInt32LE(crc32(payload), 17);
+
+    return Buffer.concat([header, payload]);
+}
+
+// sends a frame and waits for the "#snapshot ..." line the device answers with
+function send(port, data, timeout, done) {
+    const input = fs.createReadStream(port);
+    const out = fs.openSync(port, 'w');
+    let text = '';
+    let finished = false;
+
+    function finish(result) {
+        if (finished) return;
+        finished = true;
+
+        clearTimeout(timer);
+        input.destroy();
+        fs.closeSync(out);
+        done(result);
+    }
+
+    const timer = setTimeout(() => finish({ ok: false, error: 'no answer' }), timeout);
+
+    input.on('data', chunk => {
+        text += chunk.toString('latin1');
+
+        const m = /#snapshot (ok [RP] (\d+) (\d+)|error ([^\r\n]*))\r?\n/.exec(text);
+        if (!m) return;
+
+        if (m[4] !== undefined) finish({ ok: false, error: m[4] });
+        else finish({ ok: true, bytes: parseInt(m[2], 10), us: parseInt(m[3], 10) });
+    });
+
+    fs.writeSync(out, data);
+}
+
+function series(port, frames, runs, timeout, done) {
+    const results = frames.map(() => []);
+    let ix = 0;
+
+    function next() {
+        if (ix === frames.length * runs) {
+            done(results);
+            return;
+        }
+
+        const which = ix % frames.length;
+        send(port, frames[which].data, timeout, result => {
+            if (!result.ok) {
+                console.error('%s: device reported: %s', frames[which].name, result.error);
+                process.exit(1);
+            }
+            results[which].push(result);
+            ix++;
+            next();
+        });
+    }
+
+    next();
+}
+
+function report(frames, results) {
+    console.log('%s %s %s %s', 'load'.padEnd(10), 'bytes'.padStart(8), 'avg us'.padStart(10), 'min us'.padStart(10));
+
+    frames.forEach((f, ix) => {
+        const us = results[ix].map(r => r.us);
+        const avg = Math.round(us.reduce((a, b) => a + b, 0) / us.length);
+        console.log('%s %s %s %s', f.name.padEnd(10), String(f.payload.length).padStart(8),
+            String(avg).padStart(10), String(Math.min.apply(null, us)).padStart(10));
+    });
+}
+
+function main(argv) {
+    const args = { jerry: 'jerry', runs: 1, timeout: 10000 };
+    for (let ix = 0; ix < argv.length; ix++) {
+        if (argv[ix] === '--port') args.port = argv[++ix];
+        else if (argv[ix] === '--out') args.out = argv[++ix];
+        else if (argv[ix] === '--jerry') args.jerry = argv[++ix];
+        else if (argv[ix] === '--compare') args.compare = true;
+        else if (argv[ix] === '--runs') args.runs = parseInt(argv[++ix], 10);
+        else if (argv[ix] === '--timeout') args.timeout = parseInt(argv[++ix], 10);
+        else args.file = argv[ix];
+    }
+
+    if (!args.file || !(args.port || args.out) || (args.compare && (args.out || !args.file.endsWith('.js')))) {
+        console.error('usage: snapshot-upload.js <file.js|file.snapshot> (--port <device> | --out <file>)');
+        console.error('           [--jerry <path>] [--compare] [--runs <n>] [--timeout <ms>]');
+        console.error('--compare needs the .js source and a port');
+        process.exit(2);
+    }
+
+    const snapshot = args.file.endsWith('.js') ? compile(args.jerry, args.file) : fs.readFileSync(args.file);
+    const frames = [{ name: 'snapshot', payload: snapshot, data: frame(RUN, snapshot) }];
+
+    if (args.compare) {
+        const source = fs.readFileSync(args.file);
+        frames.unshift({ name: 'parse', payload: source, data: frame(PARSE, source) });
+    }
+
+    if (args.out) {
+        fs.writeFileSync(args.out, frames[0].data);
+        return;
+    }
+
+    series(args.port, frames, args.runs, args.timeout, results => report(frames, results));
+}
+
+if (require.main === module) {
+    main(process.argv.slice(2));
+}
+
+// for the host tests
+module.exports = { frame: frame, RUN: RUN, PARSE: PARSE };
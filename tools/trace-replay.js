@@ -0,0 +1,269 @@
+#!/usr/bin/env node
+/**
+ * trace-replay.js
+ *
+ * Reads an I/O trace dumped with Ctrl+T (build with SERIAL_INTERFACE_TRACE)
+ * from a terminal log and reports, for every received byte, how long the
+ * device took to start answering.
+ *
+ * With --port the received bytes are sent again, with their original
+ * timing, to a device (configure the port first, e.g. `stty -F <port> raw
+ * 9600`) and the bytes it sends back are compared against the recorded ones.
+ *
+ * With --host the received bytes go through a host build of SerialInterface
+ * instead (tools/host/replay.cpp, built with the same SERIAL_INTERFACE_*
+ * macros as the firmware). The host clock follows the recorded timestamps,
+ * so pastes and timeouts behave as they did on the board. It reports the
+ * host processing latency of every byte and the first byte whose response
+ * differs from the recorded one.
+ *
+ * The Ctrl+T that ended the recording is not replayed. The replay starts
+ * from a freshly booted board, or from an empty prompt if the trace was
+ * recorded after an earlier dump. Script console output only shows up in the
+ * trace when it goes through SerialInterface (see README).
+ *
+ * Usage: node tools/trace-replay.js <log> [--port <device> | --host <replay>] [--settle <ms>]
+ */
+
+'use strict';
+
+const fs = require('fs');
+const childProcess = require('child_process');
+
+// Ctrl+T, dumps the trace
+const DUMP = 0x14;
+
+function parseTrace(text) {
+    const lines = text.split(/\r?\n/).map(l => l.trim());
+    const events = [];
+
+    // the log may hold several dumps, use the last one
+    let start = lines.length;
+    while (start-- > 0 && !lines[start].startsWith('#trace ')) { }
+
+    for (let ix = start + 1; ix < lines.length && lines[ix] !== '#end'; ix++) {
+        const m = /^([0-9a-f]{8}) ([RT]) ([0-9a-f]{2})$/.exec(lines[ix]);
+        if (!m) continue;
+        events.push({ time: parseInt(m[1], 16), dir: m[2], data: parseInt(m[3], 16) });
+    }
+
+    // us_ticker is 32 bit, unwrap to a monotonic time base
+    let offset = 0;
+    for (let ix = 1; ix < events.length; ix++) {
+        if (events[ix].time + offset < events[ix - 1].time) offset += 0x100000000;
+        events[ix].time += offset;
+    }
+
+    return events;
+}
+
+function latencies(events) {
+    const result = [];
+
+    for (let ix = 0; ix < events.length; ix++) {
+        if (events[ix].dir !== 'R') continue;
+
+        // first byte sent back before the next byte came in
+        for (let jx = ix + 1; jx < events.length && events[jx].dir !== 'R'; jx++) {
+            if (events[jx].dir === 'T') {
+                result.push({ index: ix, data: events[ix].data, us: events[jx].time - events[ix].time });
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+function report(samples) {
+    if (samples.length === 0) {
+        console.log('no RX events with a response');
+        return;
+    }
+
+    const sorted = samples.map(s => s.us).sort((a, b) => a - b);
+    const sum = sorted.reduce((a, b) => a + b, 0);
+    const pick = p => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+
+    console.log('events: %d', samples.length);
+    console.log('latency us: min %d avg %d p50 %d p99 %d max %d',
+        sorted[0], Math.round(sum / sorted.length), pick(0.5), pick(0.99), sorted[sorted.length - 1]);
+
+    console.log('slowest:');
+    samples.slice().sort((a, b) => b.us - a.us).slice(0, 5).forEach(s => {
+        console.log('  #%d 0x%s %d us', s.index, s.data.toString(16).padStart(2, '0'), s.us);
+    });
+}
+
+// the key that dumped the trace would dump again, leave it out
+function replayable(events) {
+    const result = events.slice();
+
+    for (let ix = result.length - 1; ix >= 0; ix--) {
+        if (result[ix].dir !== 'R') continue;
+        if (result[ix].data !== DUMP) break;
+        result.splice(ix, 1);
+    }
+
+    return result;
+}
+
+// bytes sent in response to each received byte, until the next one came in
+function responses(events) {
+    const result = [];
+
+    events.forEach(e => {
+        if (e.dir === 'R') result.push([]);
+        else if (result.length > 0) result[result.length - 1].push(e.data);
+    });
+
+    return result.map(bytes => Buffer.from(bytes));
+}
+
+function replay(events, port, settle, done) {
+    const rx = events.filter(e => e.dir === 'R');
+    const expected = Buffer.concat(responses(events));
+    const received = [];
+
+    const input = fs.createReadStream(port);
+    input.on('data', chunk => received.push(chunk));
+
+    const out = fs.openSync(port, 'w');
+    const t0 = process.hrtime();
+    let ix = 0;
+
+    function next() {
+        if (ix === rx.length) {
+            setTimeout(() => {
+                input.destroy();
+                fs.closeSync(out);
+                done(expected, Buffer.concat(received));
+            }, settle);
+            return;
+        }
+
+        const due = (rx[ix].time - rx[0].time) / 1000;
+        const elapsed = process.hrtime(t0);
+        const wait = due - (elapsed[0] * 1e3 + elapsed[1] / 1e6);
+
+        setTimeout(() => {
+            fs.writeSync(out, Buffer.from([rx[ix].data]));
+            ix++;
+            next();
+        }, Math.max(0, wait));
+    }
+
+    next();
+}
+
+// bytes sent before the first received one
+function bootOutput(events) {
+    const first = events.findIndex(e => e.dir === 'R');
+    return Buffer.from(events.slice(0, first < 0 ? events.length : first).map(e => e.data));
+}
+
+// whether the trace starts after a dump, which leaves a prompt behind
+function afterDump(events) {
+    const boot = bootOutput(events).toString('latin1');
+    return boot.length > 0 && !boot.startsWith('\x1b[?2004h');
+}
+
+function replayHost(events, binary) {
+    const rx = events.filter(e => e.dir === 'R');
+    const input = rx.map(e => (e.time % 0x100000000).toString(16) + ' ' + e.data.toString(16)).join('\n') + '\n';
+
+    const result = childProcess.spawnSync(binary, afterDump(events) ? ['--prompt'] : [], { input: input, maxBuffer: 1 << 28 });
+    if (result.status !== 0) {
+        console.error('%s failed: %s', binary, result.error || result.stderr.toString());
+        process.exit(2);
+    }
+
+    const samples = [];
+    const actual = [];
+
+    result.stdout.toString().split('\n').filter(l => l.length > 0).forEach(line => {
+        const fields = line.split(' ');
+
+        if (fields[0] === 'boot') {
+            // e.g. a dump taken with a program in the editor, the replay starts empty
+            const boot = Buffer.from(fields[2] || '', 'hex');
+            if (!boot.equals(bootOutput(events))) {
+                console.log('warning: the trace starts from another state, recorded %j, replay %j',
+                    bootOutput(events).toString('latin1'), boot.toString('latin1'));
+            }
+            return;
+        }
+
+        const index = parseInt(fields[0], 10);
+
+        samples.push({ index: index, data: rx[index].data, us: parseFloat(fields[1]) });
+        actual.push(Buffer.from(fields[2] || '', 'hex'));
+    });
+
+    console.log('host processing:');
+    report(samples);
+
+    return compareResponses(responses(events), actual, rx);
+}
+
+function compareResponses(expected, actual, rx) {
+    for (let ix = 0; ix < expected.length; ix++) {
+        const got = actual[ix] || Buffer.alloc(0);
+        if (expected[ix].equals(got)) continue;
+
+        console.log('output diverges at RX #%d 0x%s (expected %d bytes, got %d)', ix,
+            rx[ix].data.toString(16).padStart(2, '0'), expected[ix].length, got.length);
+        console.log('  expected: %j', expected[ix].toString('latin1'));
+        console.log('  actual:   %j', got.toString('latin1'));
+        return 1;
+    }
+
+    console.log('output matches (%d bytes)', Buffer.concat(expected).length);
+    return 0;
+}
+
+function compare(expected, actual) {
+    const length = Math.min(expected.length, actual.length);
+    let ix = 0;
+    while (ix < length && expected[ix] === actual[ix]) ix++;
+
+    if (ix === expected.length && ix === actual.length) {
+        console.log('output matches (%d bytes)', ix);
+        return 0;
+    }
+
+    console.log('output diverges at byte %d (expected %d bytes, got %d)', ix, expected.length, actual.length);
+    console.log('  expected: %j', expected.slice(ix, ix + 32).toString('latin1'));
+    console.log('  actual:   %j', actual.slice(ix, ix + 32).toString('latin1'));
+    return 1;
+}
+
+function main(argv) {
+    const args = { settle: 500 };
+    for (let ix = 0; ix < argv.length; ix++) {
+        if (argv[ix] === '--port') args.port = argv[++ix];
+        else if (argv[ix] === '--host') args.host = argv[++ix];
+        else if (argv[ix] === '--settle') args.settle = parseInt(argv[++ix], 10);
+        else args.log = argv[ix];
+    }
+
+    if (!args.log) {
+        console.error('usage: trace-replay.js <log> [--port <device> | --host <replay>] [--settle <ms>]');
+        process.exit(2);
+    }
+
+    const events = replayable(parseTrace(fs.readFileSync(args.log, 'latin1')));
+    report(latencies(events));
+
+    if (args.host) {
+        process.exit(replayHost(events, args.host));
+    }
+
+    if (args.port) {
+        replay(events, args.port, args.settle, (expected, actual) => {
+            process.exit(compare(expected, actual));
+        });
+    }
+}
+
+main(process.argv.slice(2));